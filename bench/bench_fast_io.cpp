@@ -0,0 +1,97 @@
+// Время разбора входа каждого решения: InputReader по тексту в памяти против std::istream,
+// которым решения читали вход раньше. Тексты повторяют форматы входа задач
+#include <string>
+#include <sstream>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "fast_io.h"
+#include "workloads.h"
+
+namespace {
+
+enum class Driver { TopK, KStatistics, Tree, Treap, Graph, Puzzle };
+
+void append_numbers(const std::vector<int> &numbers, std::string *text) {
+  for (int number : numbers) {
+    *text += std::to_string(number);
+    *text += ' ';
+  }
+  *text += '\n';
+}
+
+// n - количество основных элементов входа: чисел, запросов или рёбер
+std::string driver_input(Driver driver, int n) {
+  std::string text;
+  switch (driver) {
+    case Driver::TopK:
+    case Driver::KStatistics:
+      append_numbers({n, n / 2}, &text);
+      append_numbers(random_ints(n), &text);
+      break;
+    case Driver::Tree:
+      append_numbers({n}, &text);
+      append_numbers(random_ints(n), &text);
+      break;
+    case Driver::Treap: {
+      // пары (значение, k): значения положительные, k не больше номера запроса
+      auto values = random_permutation(n);
+      std::vector<int> pairs;
+      for (int i = 0; i < n; ++i) {
+        pairs.push_back(values[i] + 1);
+        pairs.push_back(i / 2);
+      }
+      append_numbers({n}, &text);
+      append_numbers(pairs, &text);
+      break;
+    }
+    case Driver::Graph:
+      append_numbers({n / 4, n}, &text);
+      append_numbers(random_graph_edges(n / 4, n), &text);
+      append_numbers({0, n / 4 - 1}, &text);
+      break;
+    case Driver::Puzzle:
+      // вход из 16 чисел, повторённый n / 16 раз, чтобы замер был заметен
+      for (int i = 0; i < n / 16; ++i) append_numbers({1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 0, 15}, &text);
+      break;
+  }
+  return text;
+}
+
+template<Driver Kind>
+void BM_ParseInputReader(benchmark::State &state) {
+  auto text = driver_input(Kind, static_cast<int>(state.range(0)));
+  for (auto _ : state) {
+    InputReader reader(text.data(), text.size());
+    long long sum = 0;
+    int value;
+    while (reader.read_int(&value)) sum += value;
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+template<Driver Kind>
+void BM_ParseIstream(benchmark::State &state) {
+  auto text = driver_input(Kind, static_cast<int>(state.range(0)));
+  for (auto _ : state) {
+    std::istringstream stream(text);
+    long long sum = 0;
+    int value;
+    while (stream >> value) sum += value;
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+}
+
+#define PARSE_BENCHMARKS(kind) \
+  BENCHMARK_TEMPLATE(BM_ParseInputReader, kind)->RangeMultiplier(16)->Range(1 << 12, 1 << 20); \
+  BENCHMARK_TEMPLATE(BM_ParseIstream, kind)->RangeMultiplier(16)->Range(1 << 12, 1 << 20)
+
+PARSE_BENCHMARKS(Driver::TopK);
+PARSE_BENCHMARKS(Driver::KStatistics);
+PARSE_BENCHMARKS(Driver::Tree);
+PARSE_BENCHMARKS(Driver::Treap);
+PARSE_BENCHMARKS(Driver::Graph);
+PARSE_BENCHMARKS(Driver::Puzzle);
@@ -0,0 +1,142 @@
+// Количество кратчайших путей в случайном графе со средней степенью 8: обычный, двусторонний
+// и параллельный обход в ширину, пакет запросов и обход после перенумерации вершин.
+// Обычный и параллельный обходы сравниваются для всех типов счётчика путей, в том числе на решётке,
+// где число путей из угла в угол растёт экспоненциально и BigCount работает с длинными числами
+#include <vector>
+#include <utility>
+#include <random>
+#include <thread>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <benchmark/benchmark.h>
+#include "graph.h"
+#include "workloads.h"
+
+namespace {
+
+const int AverageDegree = 8;
+const int QueriesCount = 64;
+
+std::vector<std::pair<int, int>> random_queries(int n_vertexes) {
+  std::mt19937 random(WorkloadSeed + 1);
+  std::uniform_int_distribution<int> vertex(0, n_vertexes - 1);
+  std::vector<std::pair<int, int>> result(QueriesCount);
+  for (auto &query : result) query = {vertex(random), vertex(random)};
+  return result;
+}
+
+int bench_threads() {
+  return std::max(2, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+enum class GraphShape { Random, Grid };
+
+// для решётки n округляется вниз до квадрата
+int shape_vertexes(GraphShape shape, int n) {
+  if (shape == GraphShape::Random) return n;
+  int side = static_cast<int>(std::sqrt(static_cast<double>(n)));
+  return side * side;
+}
+
+std::vector<int> shape_edges(GraphShape shape, int n_vertexes) {
+  if (shape == GraphShape::Random) return random_graph_edges(n_vertexes, n_vertexes * AverageDegree / 2);
+  return grid_graph_edges(static_cast<int>(std::sqrt(static_cast<double>(n_vertexes))));
+}
+
+// на решётке один запрос из угла в угол, на нём путей больше всего
+std::vector<std::pair<int, int>> shape_queries(GraphShape shape, int n_vertexes) {
+  if (shape == GraphShape::Random) return random_queries(n_vertexes);
+  return {{0, n_vertexes - 1}};
+}
+
+template<typename PathCountT, GraphShape Shape>
+void BM_ShortestPaths(benchmark::State &state) {
+  int n = shape_vertexes(Shape, static_cast<int>(state.range(0)));
+  SimpleGraph graph(n, shape_edges(Shape, n));
+  auto queries = shape_queries(Shape, n);
+  BfsState<PathCountT> bfs(n);
+  for (auto _ : state) {
+    for (const auto &query : queries) {
+      benchmark::DoNotOptimize(shortest_paths_quantity(graph, query.first, query.second, &bfs));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * queries.size());
+}
+
+void BM_BidirectionalShortestPaths(benchmark::State &state) {
+  int n = static_cast<int>(state.range(0));
+  SimpleGraph graph(n, random_graph_edges(n, n * AverageDegree / 2));
+  auto queries = random_queries(n);
+  BfsState<PathCount> forward(n);
+  BfsState<PathCount> backward(n);
+  for (auto _ : state) {
+    for (const auto &query : queries) {
+      benchmark::DoNotOptimize(
+          bidirectional_shortest_paths_quantity(graph, query.first, query.second, &forward, &backward));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * queries.size());
+}
+
+template<typename PathCountT, GraphShape Shape>
+void BM_ParallelShortestPaths(benchmark::State &state) {
+  int n = shape_vertexes(Shape, static_cast<int>(state.range(0)));
+  SimpleGraph graph(n, shape_edges(Shape, n));
+  auto queries = shape_queries(Shape, n);
+  int threads = bench_threads();
+  for (auto _ : state) {
+    for (const auto &query : queries) {
+      benchmark::DoNotOptimize(
+          parallel_shortest_paths_quantity<PathCountT>(graph, query.first, query.second, threads));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * queries.size());
+}
+
+void BM_BatchShortestPaths(benchmark::State &state) {
+  int n = static_cast<int>(state.range(0));
+  SimpleGraph graph(n, random_graph_edges(n, n * AverageDegree / 2));
+  auto queries = random_queries(n);
+  int threads = bench_threads();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(batch_shortest_paths_quantity<PathCount>(graph, queries, threads));
+  }
+  state.SetItemsProcessed(state.iterations() * queries.size());
+}
+
+void BM_ReorderedShortestPaths(benchmark::State &state) {
+  int n = static_cast<int>(state.range(0));
+  SimpleGraph original(n, random_graph_edges(n, n * AverageDegree / 2));
+  SimpleGraph graph(original, cuthill_mckee_order(original));
+  auto queries = random_queries(n);
+  BfsState<PathCount> bfs(n);
+  for (auto _ : state) {
+    for (const auto &query : queries) {
+      benchmark::DoNotOptimize(
+          shortest_paths_quantity(graph, graph.vertex(query.first), graph.vertex(query.second), &bfs));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * queries.size());
+}
+
+}
+
+typedef unsigned __int128 Count128;
+typedef ModularCount<1000000007> CountModulo;
+
+#define COUNT_BENCHMARKS(count) \
+  BENCHMARK_TEMPLATE(BM_ShortestPaths, count, GraphShape::Random)->RangeMultiplier(8)->Range(1 << 12, 1 << 18); \
+  BENCHMARK_TEMPLATE(BM_ShortestPaths, count, GraphShape::Grid)->RangeMultiplier(8)->Range(1 << 12, 1 << 18); \
+  BENCHMARK_TEMPLATE(BM_ParallelShortestPaths, count, GraphShape::Random)->RangeMultiplier(8)->Range(1 << 12, 1 << 18) \
+      ->UseRealTime(); \
+  BENCHMARK_TEMPLATE(BM_ParallelShortestPaths, count, GraphShape::Grid)->RangeMultiplier(8)->Range(1 << 12, 1 << 18) \
+      ->UseRealTime()
+
+COUNT_BENCHMARKS(uint64_t);
+COUNT_BENCHMARKS(Count128);
+COUNT_BENCHMARKS(BigCount);
+COUNT_BENCHMARKS(CountModulo);
+BENCHMARK(BM_BidirectionalShortestPaths)->RangeMultiplier(8)->Range(1 << 12, 1 << 18);
+BENCHMARK(BM_BatchShortestPaths)->RangeMultiplier(8)->Range(1 << 12, 1 << 18)->UseRealTime();
+BENCHMARK(BM_ReorderedShortestPaths)->RangeMultiplier(8)->Range(1 << 12, 1 << 18);
@@ -0,0 +1,48 @@
+// Множество строк на хеш-таблице с открытой адресацией, с той же хеш-функцией Горнера, что и решение задачи
+#include <string>
+#include <functional>
+#include <benchmark/benchmark.h>
+#include "hash_set.h"
+#include "workloads.h"
+
+namespace {
+
+typedef OpenAddressingSet<std::string, std::function<int(std::string)>> StringSet;
+
+int horner_hash(const std::string &s) {
+  const int a = 64;
+  unsigned int hash = 0;
+  for (char const c: s) {
+    hash = hash * a + (unsigned int) c;
+  }
+  return hash;
+}
+
+void BM_HashSetPut(benchmark::State &state) {
+  auto words = random_words(static_cast<int>(state.range(0)), 12);
+  for (auto _ : state) {
+    StringSet set(horner_hash, "");
+    for (const auto &word : words) set.put(word);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * words.size());
+}
+
+void BM_HashSetContains(benchmark::State &state) {
+  int n = static_cast<int>(state.range(0));
+  // добавляется первая половина слов, запросы идут по всем: половина попаданий, половина промахов
+  auto words = random_words(2 * n, 12);
+  StringSet set(horner_hash, "");
+  for (int i = 0; i < n; ++i) set.put(words[i]);
+  for (auto _ : state) {
+    int found = 0;
+    for (const auto &word : words) found += set.contains(word);
+    benchmark::DoNotOptimize(found);
+  }
+  state.SetItemsProcessed(state.iterations() * words.size());
+}
+
+}
+
+BENCHMARK(BM_HashSetPut)->RangeMultiplier(8)->Range(1 << 10, 1 << 17);
+BENCHMARK(BM_HashSetContains)->RangeMultiplier(8)->Range(1 << 10, 1 << 17);
@@ -0,0 +1,84 @@
+// Сжатие и распаковка кодами Хаффмана текста с неравномерным распределением символов
+// и время жизни дерева кодов с обычным выделением памяти и с ареной
+#include <vector>
+#include <map>
+#include <benchmark/benchmark.h>
+#include "Huffman.h"
+#include "haffman_tree.h"
+#include "workloads.h"
+#include "lifetime.h"
+
+namespace {
+
+class VectorInputStream : public IInputStream {
+ public:
+  explicit VectorInputStream(const std::vector<byte> &data) : data(data) {}
+  bool Read(byte &value) override {
+    if (position == data.size()) return false;
+    value = data[position++];
+    return true;
+  }
+ private:
+  const std::vector<byte> &data;
+  size_t position = 0;
+};
+
+class VectorOutputStream : public IOutputStream {
+ public:
+  explicit VectorOutputStream(std::vector<byte> &data) : data(data) {}
+  void Write(byte value) override {
+    data.push_back(value);
+  }
+ private:
+  std::vector<byte> &data;
+};
+
+void BM_HuffmanEncode(benchmark::State &state) {
+  auto original = skewed_bytes(static_cast<int>(state.range(0)));
+  std::vector<byte> compressed;
+  for (auto _ : state) {
+    compressed.clear();
+    VectorInputStream input(original);
+    VectorOutputStream output(compressed);
+    Encode(input, output);
+  }
+  state.SetBytesProcessed(state.iterations() * original.size());
+  state.counters["ratio"] = static_cast<double>(compressed.size()) / original.size();
+}
+
+void BM_HuffmanDecode(benchmark::State &state) {
+  auto original = skewed_bytes(static_cast<int>(state.range(0)));
+  std::vector<byte> compressed;
+  VectorInputStream encode_input(original);
+  VectorOutputStream encode_output(compressed);
+  Encode(encode_input, encode_output);
+  std::vector<byte> decoded;
+  for (auto _ : state) {
+    decoded.clear();
+    VectorInputStream input(compressed);
+    VectorOutputStream output(decoded);
+    Decode(input, output);
+  }
+  if (decoded != original) state.SkipWithError("decoded data differs from the original");
+  state.SetBytesProcessed(state.iterations() * original.size());
+}
+
+// дерево для алфавита из range(0) символов с частотами как в skewed_bytes
+template<Allocation Kind>
+void BM_HaffmanTreeLifetime(benchmark::State &state) {
+  auto text = skewed_bytes(1 << 20);
+  std::map<byte, int> frequency_map;
+  for (int symbol = 0; symbol < state.range(0); ++symbol) frequency_map[static_cast<byte>(symbol)] = 1;
+  for (byte value : text) ++frequency_map[static_cast<byte>((value - 'a') % state.range(0))];
+  measure_lifetime<HaffmanTree>(state, Kind, 0, [&frequency_map](std::optional<HaffmanTree> *tree,
+                                                                 std::pmr::memory_resource *resource) {
+    tree->emplace(&frequency_map, resource);
+  });
+}
+
+}
+
+BENCHMARK_TEMPLATE(BM_HaffmanTreeLifetime, Allocation::Default)->Arg(16)->Arg(64)->Arg(256);
+BENCHMARK_TEMPLATE(BM_HaffmanTreeLifetime, Allocation::Arena)->Arg(16)->Arg(64)->Arg(256);
+BENCHMARK(BM_HuffmanEncode)->RangeMultiplier(8)->Range(1 << 10, 1 << 22);
+BENCHMARK(BM_HuffmanDecode)->RangeMultiplier(8)->Range(1 << 10, 1 << 22);
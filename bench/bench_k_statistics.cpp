@@ -0,0 +1,103 @@
+// Медиана n чисел: quickselect против std::nth_element на случайных, упорядоченных, одинаковых и подобранных
+// против выбора опорного элемента данных, параллельный выбор и приближённый KLL-скетч
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <benchmark/benchmark.h>
+#include "k_statistics.h"
+#include "workloads.h"
+
+namespace {
+
+template<IntPattern Pattern>
+std::vector<int> patterned(int n) {
+  return patterned_ints(n, Pattern);
+}
+
+// Вход, подобранный против самого get_k_order_statistic (противник Макилроя): выбор запускается на номерах
+// элементов, а их значения фиксируются лениво, во время сравнений, так, чтобы опорный элемент по выборке
+// всякий раз оказывался у края отрезка. Без медианы медиан выбор на таком входе квадратичный
+std::vector<int> adversarial(int n) {
+  // значение n - ещё не зафиксированный элемент, он больше всех зафиксированных
+  std::vector<int> values(n, n);
+  int solid = 0;
+  int candidate = 0;
+  auto compare = [&](int first, int second) {
+    if (values[first] == n and values[second] == n) {
+      values[first == candidate ? first : second] = solid++;
+    }
+    if (values[first] == n) {
+      candidate = first;
+    } else if (values[second] == n) {
+      candidate = second;
+    }
+    return values[first] < values[second];
+  };
+  std::vector<int> indexes(n);
+  for (int i = 0; i < n; ++i) indexes[i] = i;
+  get_k_order_statistic(n, n / 2, indexes.data(), compare);
+  for (int &value : values) {
+    if (value == n) value = solid++;
+  }
+  return values;
+}
+
+template<std::vector<int> (*Input)(int)>
+void BM_KOrderStatistic(benchmark::State &state) {
+  auto values = Input(static_cast<int>(state.range(0)));
+  std::vector<int> arr(values.size());
+  int n = static_cast<int>(values.size());
+  for (auto _ : state) {
+    arr = values;
+    benchmark::DoNotOptimize(get_k_order_statistic(n, n / 2, arr.data(), ComparerLess<int>()));
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+void BM_ParallelKOrderStatistic(benchmark::State &state) {
+  auto values = random_ints(static_cast<int>(state.range(0)));
+  int n = static_cast<int>(values.size());
+  int threads = std::max(2u, std::thread::hardware_concurrency());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(parallel_k_order_statistic(n, n / 2, values.data(), ComparerLess<int>(), threads));
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+template<std::vector<int> (*Input)(int)>
+void BM_NthElement(benchmark::State &state) {
+  auto values = Input(static_cast<int>(state.range(0)));
+  std::vector<int> arr(values.size());
+  for (auto _ : state) {
+    arr = values;
+    std::nth_element(arr.begin(), arr.begin() + arr.size() / 2, arr.end());
+    benchmark::DoNotOptimize(arr[arr.size() / 2]);
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+void BM_KllSketch(benchmark::State &state) {
+  auto values = random_ints(static_cast<int>(state.range(0)));
+  long long n = static_cast<long long>(values.size());
+  for (auto _ : state) {
+    KllSketch<int, ComparerLess<int>> sketch(200, ComparerLess<int>());
+    for (int value : values) sketch.update(value);
+    benchmark::DoNotOptimize(sketch.get_k_stat(n / 2));
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+}
+
+#define SELECT_BENCHMARKS(input) \
+  BENCHMARK_TEMPLATE(BM_KOrderStatistic, input)->RangeMultiplier(8)->Range(1 << 12, 1 << 21); \
+  BENCHMARK_TEMPLATE(BM_NthElement, input)->RangeMultiplier(8)->Range(1 << 12, 1 << 21)
+
+SELECT_BENCHMARKS(patterned<IntPattern::Random>);
+SELECT_BENCHMARKS(patterned<IntPattern::Sorted>);
+SELECT_BENCHMARKS(patterned<IntPattern::AllEqual>);
+SELECT_BENCHMARKS(patterned<IntPattern::OrganPipe>);
+SELECT_BENCHMARKS(patterned<IntPattern::MedianOfThreeKiller>);
+SELECT_BENCHMARKS(adversarial);
+BENCHMARK(BM_ParallelKOrderStatistic)->RangeMultiplier(8)->Range(1 << 12, 1 << 21)->UseRealTime();
+BENCHMARK(BM_KllSketch)->RangeMultiplier(8)->Range(1 << 12, 1 << 21);
@@ -0,0 +1,45 @@
+// Решение пятнашек алгоритмом A* для позиций, полученных случайными ходами из собранной,
+// словари пройденных позиций в обычной памяти и в арене, которая освобождается целиком
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include "puzzle.h"
+#include "workloads.h"
+#include "lifetime.h"
+
+namespace {
+
+// depth случайных ходов без немедленного возврата на предыдущую позицию
+position scrambled_position(int depth) {
+  std::mt19937 random(WorkloadSeed);
+  position current = finish_position;
+  position previous = current;
+  for (int i = 0; i < depth; ++i) {
+    auto siblings = current.siblings();
+    siblings.erase(std::remove(siblings.begin(), siblings.end(), previous), siblings.end());
+    previous = current;
+    current = siblings[random() % siblings.size()];
+  }
+  return current;
+}
+
+template<Allocation Kind>
+void BM_SolveBarleyBreak(benchmark::State &state) {
+  auto start = scrambled_position(static_cast<int>(state.range(0)));
+  size_t moves = 0;
+  for (auto _ : state) {
+    BenchResource resource(Kind, 0);
+    auto result = solve_barley_break(start, resource.get());
+    moves = result.second.size();
+    benchmark::DoNotOptimize(result.first);
+  }
+  state.counters["moves"] = static_cast<double>(moves);
+}
+
+}
+
+BENCHMARK_TEMPLATE(BM_SolveBarleyBreak, Allocation::Default)->Arg(10)->Arg(20)->Arg(40)->Arg(80)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_SolveBarleyBreak, Allocation::Arena)->Arg(10)->Arg(20)->Arg(40)->Arg(80)
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,196 @@
+// k наименьших из n случайных чисел: слияние, куча, quickselect, поиск по текстовому и бинарному файлам
+// на 1-16 потоках, и сама сортировка слиянием против std::stable_sort и std::sort
+// на случайных, упорядоченных и повторяющихся данных
+#include <vector>
+#include <deque>
+#include <string>
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <benchmark/benchmark.h>
+#include "top_k.h"
+#include "workloads.h"
+
+namespace {
+
+template<typename TopKT>
+void BM_TopK(benchmark::State &state) {
+  auto values = random_ints(static_cast<int>(state.range(0)));
+  int k = static_cast<int>(state.range(1));
+  for (auto _ : state) {
+    TopKT top_k(k, ComparerLess<int>());
+    for (int value : values) top_k.add(value);
+    benchmark::DoNotOptimize(top_k.result());
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+void BM_MergeTopKBlocks(benchmark::State &state) {
+  auto values = random_ints(static_cast<int>(state.range(0)));
+  int k = static_cast<int>(state.range(1));
+  for (auto _ : state) {
+    MergeTopK<int, ComparerLess<int>> top_k(k, ComparerLess<int>());
+    top_k.add_block(values.data(), static_cast<int>(values.size()));
+    benchmark::DoNotOptimize(top_k.result());
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+template<IntPattern Pattern>
+void BM_MergeSort(benchmark::State &state) {
+  auto values = patterned_ints(static_cast<int>(state.range(0)), Pattern);
+  int n = static_cast<int>(values.size());
+  std::vector<int> arr(n);
+  std::vector<int> buffer(n);
+  std::vector<int> bounds(merge_sort_bounds_size(n));
+  for (auto _ : state) {
+    arr = values;
+    merge_sort(arr.data(), n, 0, ComparerLess<int>(), buffer.data(), bounds.data());
+    benchmark::DoNotOptimize(arr.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+// merge_sort устойчива, честное сравнение - с std::stable_sort
+template<IntPattern Pattern>
+void BM_StableSort(benchmark::State &state) {
+  auto values = patterned_ints(static_cast<int>(state.range(0)), Pattern);
+  std::vector<int> arr(values.size());
+  for (auto _ : state) {
+    arr = values;
+    std::stable_sort(arr.begin(), arr.end());
+    benchmark::DoNotOptimize(arr.data());
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+template<IntPattern Pattern>
+void BM_StdSort(benchmark::State &state) {
+  auto values = patterned_ints(static_cast<int>(state.range(0)), Pattern);
+  std::vector<int> arr(values.size());
+  for (auto _ : state) {
+    arr = values;
+    std::sort(arr.begin(), arr.end());
+    benchmark::DoNotOptimize(arr.data());
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+// Короткие куски, как вторая половина буфера MergeTopK при малом k: массив режется на блоки по n,
+// и каждый сортируется отдельно. Блоков много и все разные, так что предсказатель переходов
+// не запоминает порядок сравнений, как при многократной сортировке одного маленького массива
+template<IntPattern Pattern>
+void BM_MergeSortBlocks(benchmark::State &state) {
+  auto values = patterned_ints(1 << 16, Pattern);
+  int n = static_cast<int>(state.range(0));
+  std::vector<int> arr(values.size());
+  std::vector<int> buffer(n);
+  std::vector<int> bounds(merge_sort_bounds_size(n));
+  for (auto _ : state) {
+    arr = values;
+    for (size_t start = 0; start + n <= arr.size(); start += n) {
+      merge_sort(arr.data() + start, n, 0, ComparerLess<int>(), buffer.data(), bounds.data());
+    }
+    benchmark::DoNotOptimize(arr.data());
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+template<IntPattern Pattern>
+void BM_StableSortBlocks(benchmark::State &state) {
+  auto values = patterned_ints(1 << 16, Pattern);
+  int n = static_cast<int>(state.range(0));
+  std::vector<int> arr(values.size());
+  for (auto _ : state) {
+    arr = values;
+    for (size_t start = 0; start + n <= arr.size(); start += n) {
+      std::stable_sort(arr.begin() + start, arr.begin() + start + n);
+    }
+    benchmark::DoNotOptimize(arr.data());
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+// Файлы для top_k_from_files пишутся один раз при первом запуске и сразу удаляются:
+// отображение в память остаётся, а после бенчмарка на диске ничего не остаётся
+const int TopKFileSize = 1 << 23;
+std::deque<MappedFile> *text_files = nullptr;
+std::deque<MappedFile> *binary_files = nullptr;
+
+void map_temporary_file(const std::string &contents, const char *name, std::deque<MappedFile> *files) {
+  auto path = (std::filesystem::temp_directory_path() / name).string();
+  FILE *file = fopen(path.c_str(), "wb");
+  if (file == nullptr) return;
+  fwrite(contents.data(), 1, contents.size(), file);
+  fclose(file);
+  files->emplace_back(path.c_str());
+  std::remove(path.c_str());
+}
+
+void create_top_k_files(const benchmark::State &) {
+  if (text_files != nullptr) return;
+  auto values = random_ints(TopKFileSize);
+  std::string text;
+  char number[16];
+  for (int value : values) {
+    text.append(number, snprintf(number, sizeof(number), "%d ", value));
+  }
+  std::string binary(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(int));
+  text_files = new std::deque<MappedFile>();
+  binary_files = new std::deque<MappedFile>();
+  map_temporary_file(text, "algo_bench_top_k.txt", text_files);
+  map_temporary_file(binary, "algo_bench_top_k.bin", binary_files);
+}
+
+// Поиск по уже отображённому файлу: разбор (для текста) и отбор на range(1) потоках.
+// Время - настоящее, а не процессорное, иначе ускорение от потоков не видно
+template<bool Binary>
+void BM_TopKFromFiles(benchmark::State &state) {
+  int k = static_cast<int>(state.range(0));
+  int threads = static_cast<int>(state.range(1));
+  const std::deque<MappedFile> &files = Binary ? *binary_files : *text_files;
+  if (files.empty() or !files.front().is_open()) {
+    state.SkipWithError("cannot create the input file");
+    return;
+  }
+  std::vector<int> result;
+  for (auto _ : state) {
+    bool valid = top_k_from_files<int>(files, Binary, k, ComparerLess<int>(), threads, &result);
+    benchmark::DoNotOptimize(valid);
+    benchmark::DoNotOptimize(result.data());
+  }
+  state.SetItemsProcessed(state.iterations() * TopKFileSize);
+  state.SetBytesProcessed(state.iterations() * files.front().size());
+}
+
+// k от 10 до 10^6 на n = 2^22, где k всё ещё много меньше n: при больших k куча, слияние и quickselect
+// расходятся сильнее всего
+void top_k_sizes(benchmark::internal::Benchmark *benchmark) {
+  for (int n : {1 << 14, 1 << 17, 1 << 20}) {
+    for (int k : {16, 1024}) benchmark->Args({n, k});
+  }
+  for (int k : {10, 1024, 100000, 1000000}) benchmark->Args({1 << 22, k});
+}
+
+}
+
+BENCHMARK_TEMPLATE(BM_TopK, MergeTopK<int, ComparerLess<int>>)->Apply(top_k_sizes);
+BENCHMARK_TEMPLATE(BM_TopK, HeapTopK<int, ComparerLess<int>>)->Apply(top_k_sizes);
+BENCHMARK_TEMPLATE(BM_TopK, SelectTopK<int, ComparerLess<int>>)->Apply(top_k_sizes);
+BENCHMARK(BM_MergeTopKBlocks)->Apply(top_k_sizes);
+BENCHMARK_TEMPLATE(BM_TopKFromFiles, false)->Setup(create_top_k_files)
+    ->ArgsProduct({{1024}, {1, 2, 4, 8, 16}})->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_TopKFromFiles, true)->Setup(create_top_k_files)
+    ->ArgsProduct({{1024}, {1, 2, 4, 8, 16}})->UseRealTime()->Unit(benchmark::kMillisecond);
+// блоки до 16 элементов сортирует сеть, остальные размеры - слияние прогонов
+#define SORT_BENCHMARKS(pattern) \
+  BENCHMARK_TEMPLATE(BM_MergeSort, pattern)->RangeMultiplier(8)->Range(1 << 10, 1 << 19); \
+  BENCHMARK_TEMPLATE(BM_StableSort, pattern)->RangeMultiplier(8)->Range(1 << 10, 1 << 19); \
+  BENCHMARK_TEMPLATE(BM_StdSort, pattern)->RangeMultiplier(8)->Range(1 << 10, 1 << 19); \
+  BENCHMARK_TEMPLATE(BM_MergeSortBlocks, pattern)->Arg(8)->Arg(16)->Arg(24); \
+  BENCHMARK_TEMPLATE(BM_StableSortBlocks, pattern)->Arg(8)->Arg(16)->Arg(24)
+
+SORT_BENCHMARKS(IntPattern::Random);
+SORT_BENCHMARKS(IntPattern::Sorted);
+SORT_BENCHMARKS(IntPattern::Reversed);
+SORT_BENCHMARKS(IntPattern::FewUnique);
@@ -0,0 +1,240 @@
+// Множество с порядковыми статистиками: декартово дерево против B-дерева с размерами поддеревьев,
+// пакетные запросы и обновления против одиночных,
+// хранение повторов счётчиком против отдельных вершин на ключах с распределением Ципфа,
+// время жизни декартова дерева с обычным выделением памяти, с ареной и с пулом вершин,
+// масштабирование читателей персистентного дерева по числу потоков при постоянной записи
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <benchmark/benchmark.h>
+#include "treap.h"
+#include "workloads.h"
+#include "lifetime.h"
+
+namespace {
+
+template<typename SetT>
+void BM_Add(benchmark::State &state) {
+  auto values = random_permutation(static_cast<int>(state.range(0)));
+  for (auto _ : state) {
+    SetT set((ComparerLess<int>()));
+    for (int value : values) set.add(value);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+template<typename SetT>
+void BM_GetKStat(benchmark::State &state) {
+  auto values = random_permutation(static_cast<int>(state.range(0)));
+  SetT set((ComparerLess<int>()));
+  for (int value : values) set.add(value);
+  for (auto _ : state) {
+    long long sum = 0;
+    for (int k : values) sum += set.get_k_stat(k);
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+void BM_TreapBuildFromSorted(benchmark::State &state) {
+  int n = static_cast<int>(state.range(0));
+  std::vector<int> values(n);
+  for (int i = 0; i < n; ++i) values[i] = i;
+  for (auto _ : state) {
+    Treap<int, ComparerLess<int>> treap((ComparerLess<int>()));
+    treap.build_from_sorted(values);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+typedef Treap<int, ComparerLess<int>> IntTreap;
+typedef CountedBTree<int, ComparerLess<int>> IntBTree;
+
+template<Allocation Kind>
+void BM_TreapLifetime(benchmark::State &state) {
+  auto values = random_permutation(static_cast<int>(state.range(0)));
+  measure_lifetime<IntTreap>(state, Kind, sizeof(TreapNode<int>), [&values](std::optional<IntTreap> *treap,
+                                                                            std::pmr::memory_resource *resource) {
+    treap->emplace(ComparerLess<int>(), resource);
+    for (int value : values) (*treap)->add(value);
+  });
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+typedef Treap<int, ComparerLess<int>, true> IntCountedTreap;
+
+// Вставка ключей Ципфа (n ключей, range(1) различных, показатель 1): при CountDuplicates повторы
+// не создают вершин, а только увеличивают счётчики. Память дерева берётся из арены,
+// её заполнение попадает в счётчик bytes
+template<typename TreapT>
+void BM_TreapZipfAdd(benchmark::State &state) {
+  auto values = zipf_ints(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)), 1.0);
+  size_t bytes = 0;
+  for (auto _ : state) {
+    MonotonicArena arena(1 << 16);
+    TreapT treap(ComparerLess<int>(), &arena);
+    for (int value : values) treap.add(value);
+    benchmark::ClobberMemory();
+    bytes = arena.used();
+  }
+  state.counters["bytes"] = static_cast<double>(bytes);
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+// Порядковые статистики по тому же мультимножеству: со счётчиками дерево ниже на число повторов
+template<typename TreapT>
+void BM_TreapZipfGetKStat(benchmark::State &state) {
+  auto values = zipf_ints(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)), 1.0);
+  TreapT treap((ComparerLess<int>()));
+  for (int value : values) treap.add(value);
+  auto ks = random_permutation(static_cast<int>(values.size()));
+  for (auto _ : state) {
+    long long sum = 0;
+    for (int k : ks) sum += treap.get_k_stat(k);
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * ks.size());
+}
+
+void zipf_sizes(benchmark::internal::Benchmark *benchmark) {
+  for (int universe : {1 << 6, 1 << 10, 1 << 14, 1 << 18}) benchmark->Args({1 << 18, universe});
+}
+
+// Дерево из n чётных чисел и отсортированный пакет из batch случайных нечётных, которых в дереве нет
+void batch_workload(int n, int batch, IntTreap *treap, std::vector<int> *values) {
+  std::vector<int> present(n);
+  for (int i = 0; i < n; ++i) present[i] = 2 * i;
+  treap->build_from_sorted(present);
+  auto order = random_permutation(n);
+  values->resize(batch);
+  for (int i = 0; i < batch; ++i) (*values)[i] = 2 * order[i] + 1;
+  std::sort(values->begin(), values->end());
+}
+
+// Пакет порядковых статистик за один общий спуск против отдельного спуска на каждый k
+template<bool Batched>
+void BM_TreapGetKStats(benchmark::State &state) {
+  int n = static_cast<int>(state.range(0));
+  IntTreap treap((ComparerLess<int>()));
+  std::vector<int> ks;
+  batch_workload(n, static_cast<int>(state.range(1)), &treap, &ks);
+  // нечётные значения пакета годятся и как номера статистик: все меньше 2n
+  for (int &k : ks) k /= 2;
+  for (auto _ : state) {
+    if (Batched) {
+      benchmark::DoNotOptimize(treap.get_k_stats(ks).data());
+    } else {
+      long long sum = 0;
+      for (int k : ks) sum += treap.get_k_stat(k);
+      benchmark::DoNotOptimize(sum);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * ks.size());
+}
+
+// Пакетная вставка и удаление (слияние отсортированного пакета с деревом) против вставки и удаления по одному.
+// Пакет удаляется в той же итерации, так что размер дерева не меняется
+template<bool Batched>
+void BM_TreapUpdateBatch(benchmark::State &state) {
+  int n = static_cast<int>(state.range(0));
+  IntTreap treap((ComparerLess<int>()));
+  std::vector<int> values;
+  batch_workload(n, static_cast<int>(state.range(1)), &treap, &values);
+  for (auto _ : state) {
+    if (Batched) {
+      treap.add_many(values);
+      treap.remove_many(values);
+    } else {
+      for (int value : values) treap.add(value);
+      for (int value : values) treap.remove(value);
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * values.size() * 2);
+}
+
+void batch_sizes(benchmark::internal::Benchmark *benchmark) {
+  for (int batch : {16, 256, 4096, 65536}) benchmark->Args({1 << 18, batch});
+}
+
+typedef PersistentTreap<int, ComparerLess<int>> IntPersistentTreap;
+
+// Общее для всех потоков бенчмарка читателей: дерево и писатель, который с постоянной частотой
+// удаляет и возвращает случайные ключи, так что каждая эпоха оставляет вершины на освобождение
+const int ReadersTreapSize = 1 << 16;
+const int MaxReaderThreads = 16;
+IntPersistentTreap *readers_treap = nullptr;
+std::thread readers_writer;
+std::atomic<bool> readers_writer_stop{false};
+std::atomic<long long> readers_writer_updates{0};
+
+void start_readers_writer(const benchmark::State &) {
+  readers_treap = new IntPersistentTreap(ComparerLess<int>(), MaxReaderThreads);
+  auto values = random_permutation(ReadersTreapSize);
+  for (int value : values) readers_treap->add(value);
+  readers_writer_stop = false;
+  readers_writer = std::thread([values]() {
+    for (size_t i = 0; !readers_writer_stop.load(std::memory_order_relaxed); i = (i + 1) % values.size()) {
+      readers_treap->remove(values[i]);
+      readers_treap->add(values[i]);
+      readers_writer_updates.fetch_add(2, std::memory_order_relaxed);
+      std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+  });
+}
+
+void stop_readers_writer(const benchmark::State &) {
+  readers_writer_stop = true;
+  readers_writer.join();
+  delete readers_treap;
+  readers_treap = nullptr;
+}
+
+// Пропускная способность читателей при постоянной записи: каждая итерация - снимок и 16 запросов к нему
+void BM_PersistentTreapReaders(benchmark::State &state) {
+  int reader = readers_treap->register_reader();
+  auto ks = random_permutation(ReadersTreapSize - 1);
+  size_t next = static_cast<size_t>(state.thread_index()) * 997 % ks.size();
+  if (state.thread_index() == 0) readers_writer_updates = 0;
+  for (auto _ : state) {
+    auto snapshot = readers_treap->snapshot(reader);
+    long long sum = 0;
+    for (int i = 0; i < 16; ++i) {
+      sum += snapshot.get_k_stat(ks[next]);
+      next = next + 1 == ks.size() ? 0 : next + 1;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * 16);
+  if (state.thread_index() == 0) {
+    state.counters["writer_updates"] = benchmark::Counter(static_cast<double>(readers_writer_updates.load()),
+                                                          benchmark::Counter::kIsRate);
+  }
+}
+
+}
+
+// до 2^23 элементов: на таких размерах дерево давно не помещается в кеш, и видно, сколько экономят
+// широкие узлы B-дерева на промахах
+BENCHMARK_TEMPLATE(BM_Add, IntTreap)->RangeMultiplier(8)->Range(1 << 10, 1 << 23);
+BENCHMARK_TEMPLATE(BM_Add, IntBTree)->RangeMultiplier(8)->Range(1 << 10, 1 << 23);
+BENCHMARK_TEMPLATE(BM_GetKStat, IntTreap)->RangeMultiplier(8)->Range(1 << 10, 1 << 23);
+BENCHMARK_TEMPLATE(BM_GetKStat, IntBTree)->RangeMultiplier(8)->Range(1 << 10, 1 << 23);
+BENCHMARK_TEMPLATE(BM_TreapLifetime, Allocation::Default)->RangeMultiplier(8)->Range(1 << 10, 1 << 19);
+BENCHMARK_TEMPLATE(BM_TreapLifetime, Allocation::Arena)->RangeMultiplier(8)->Range(1 << 10, 1 << 19);
+BENCHMARK_TEMPLATE(BM_TreapLifetime, Allocation::Pool)->RangeMultiplier(8)->Range(1 << 10, 1 << 19);
+BENCHMARK_TEMPLATE(BM_TreapZipfAdd, IntTreap)->Apply(zipf_sizes);
+BENCHMARK_TEMPLATE(BM_TreapZipfAdd, IntCountedTreap)->Apply(zipf_sizes);
+BENCHMARK_TEMPLATE(BM_TreapZipfGetKStat, IntTreap)->Apply(zipf_sizes);
+BENCHMARK_TEMPLATE(BM_TreapZipfGetKStat, IntCountedTreap)->Apply(zipf_sizes);
+BENCHMARK_TEMPLATE(BM_TreapGetKStats, false)->Apply(batch_sizes);
+BENCHMARK_TEMPLATE(BM_TreapGetKStats, true)->Apply(batch_sizes);
+BENCHMARK_TEMPLATE(BM_TreapUpdateBatch, false)->Apply(batch_sizes);
+BENCHMARK_TEMPLATE(BM_TreapUpdateBatch, true)->Apply(batch_sizes);
+BENCHMARK(BM_TreapBuildFromSorted)->RangeMultiplier(8)->Range(1 << 10, 1 << 19);
+BENCHMARK(BM_PersistentTreapReaders)->Setup(start_readers_writer)->Teardown(stop_readers_writer)
+    ->ThreadRange(1, MaxReaderThreads)->UseRealTime();
@@ -0,0 +1,106 @@
+// Наивное двоичное дерево поиска: вставка в случайном, отсортированном и зигзагообразном порядке,
+// обход pre-order и его параллельное построение на 1-16 потоках, поиск в компактном дереве
+// и время жизни дерева с обычным выделением памяти и с ареной
+#include <vector>
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include "tree.h"
+#include "workloads.h"
+#include "lifetime.h"
+
+namespace {
+
+typedef SimpleTree<int, ComparerLess<int>> IntTree;
+
+template<IntPattern Pattern>
+std::vector<int> patterned(int n) {
+  return patterned_ints(n, Pattern);
+}
+
+// попеременно наименьшее и наибольшее из оставшихся: 0, n-1, 1, n-2, ... Каждая вершина становится
+// потомком предыдущей, дерево вырождается в путь длины n. В отличие от отсортированного входа,
+// новые значения не бывают ни минимумом, ни максимумом, и спуск по крайним ветвям их не ускоряет
+std::vector<int> zig_zag(int n) {
+  std::vector<int> result(n);
+  for (int i = 0; i < n; ++i) result[i] = i % 2 == 0 ? i / 2 : n - 1 - i / 2;
+  return result;
+}
+
+template<std::vector<int> (*Input)(int)>
+void BM_SimpleTreeAdd(benchmark::State &state) {
+  auto values = Input(static_cast<int>(state.range(0)));
+  for (auto _ : state) {
+    IntTree tree((ComparerLess<int>()));
+    tree.reserve(static_cast<int>(values.size()));
+    for (int value : values) tree.add(value);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+void BM_SimpleTreePreOrder(benchmark::State &state) {
+  auto values = random_ints(static_cast<int>(state.range(0)));
+  IntTree tree((ComparerLess<int>()));
+  for (int value : values) tree.add(value);
+  std::vector<int> result;
+  result.reserve(values.size());
+  for (auto _ : state) {
+    result.clear();
+    tree.pre_order_values(&result);
+    benchmark::DoNotOptimize(result.data());
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+// Масштабирование по числу потоков: вход один и тот же, меняется только число потоков-исполнителей
+void BM_ParallelPreOrder(benchmark::State &state) {
+  auto values = random_ints(static_cast<int>(state.range(0)));
+  int threads = static_cast<int>(state.range(1));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(parallel_pre_order(values, ComparerLess<int>(), threads).data());
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+template<Allocation Kind>
+void BM_SimpleTreeLifetime(benchmark::State &state) {
+  auto values = random_ints(static_cast<int>(state.range(0)));
+  measure_lifetime<IntTree>(state, Kind, 0, [&values](std::optional<IntTree> *tree,
+                                                      std::pmr::memory_resource *resource) {
+    tree->emplace(ComparerLess<int>(), resource);
+    for (int value : values) (*tree)->add(value);
+  });
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+template<bool Frozen>
+void BM_TreeContains(benchmark::State &state) {
+  auto values = random_ints(static_cast<int>(state.range(0)));
+  IntTree tree((ComparerLess<int>()));
+  for (int value : values) tree.add(value);
+  FrozenTree<int, ComparerLess<int>> frozen((ComparerLess<int>()));
+  tree.freeze(&frozen);
+  // половина запросов - присутствующие ключи
+  auto queries = random_permutation(static_cast<int>(values.size()));
+  for (size_t i = 0; i < queries.size(); i += 2) queries[i] = values[queries[i]];
+  for (auto _ : state) {
+    int found = 0;
+    for (int query : queries) found += Frozen ? frozen.contains(query) : tree.contains(query);
+    benchmark::DoNotOptimize(found);
+  }
+  state.SetItemsProcessed(state.iterations() * queries.size());
+}
+
+}
+
+BENCHMARK_TEMPLATE(BM_SimpleTreeAdd, patterned<IntPattern::Random>)->RangeMultiplier(8)->Range(1 << 10, 1 << 19);
+BENCHMARK_TEMPLATE(BM_SimpleTreeAdd, patterned<IntPattern::Sorted>)->RangeMultiplier(8)->Range(1 << 10, 1 << 19);
+// вставка зигзагом квадратична, поэтому размеры меньше
+BENCHMARK_TEMPLATE(BM_SimpleTreeAdd, zig_zag)->RangeMultiplier(4)->Range(1 << 10, 1 << 14);
+BENCHMARK(BM_SimpleTreePreOrder)->RangeMultiplier(8)->Range(1 << 10, 1 << 19);
+BENCHMARK(BM_ParallelPreOrder)->ArgsProduct({{1 << 20}, {1, 2, 4, 8, 16}})->UseRealTime();
+BENCHMARK_TEMPLATE(BM_SimpleTreeLifetime, Allocation::Default)->RangeMultiplier(8)->Range(1 << 10, 1 << 19);
+BENCHMARK_TEMPLATE(BM_SimpleTreeLifetime, Allocation::Arena)->RangeMultiplier(8)->Range(1 << 10, 1 << 19);
+// до 2^23 ключей: видно, как меняется выигрыш раскладки Эйтцингера, когда дерево перестаёт помещаться в кеш
+BENCHMARK_TEMPLATE(BM_TreeContains, false)->RangeMultiplier(8)->Range(1 << 10, 1 << 23);
+BENCHMARK_TEMPLATE(BM_TreeContains, true)->RangeMultiplier(8)->Range(1 << 10, 1 << 23);
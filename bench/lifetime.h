@@ -0,0 +1,51 @@
+// Время жизни структуры с разными источниками памяти: построение и разрушение замеряются отдельно
+// и попадают в счётчики build и teardown (наносекунды на итерацию), общее время итерации - их сумма
+#pragma once
+
+#include <chrono>
+#include <optional>
+#include <memory_resource>
+#include <benchmark/benchmark.h>
+#include "../common/memory_resources.h"
+
+enum class Allocation { Default, Arena, Pool };
+
+// Источник памяти на одну итерацию: арена или пул создаются заново и разрушаются вместе со структурой
+class BenchResource {
+ public:
+  BenchResource(Allocation allocation, size_t pool_block_size) {
+    if (allocation == Allocation::Arena) arena.emplace(1 << 16);
+    if (allocation == Allocation::Pool) pool.emplace(pool_block_size);
+  }
+  std::pmr::memory_resource *get() {
+    if (arena) return &*arena;
+    if (pool) return &*pool;
+    return std::pmr::get_default_resource();
+  }
+ private:
+  std::optional<MonotonicArena> arena;
+  std::optional<FixedSizePool> pool;
+};
+
+// структура и её источник памяти живут в optional, чтобы разрушить их внутри замера;
+// build(&structure, resource) строит структуру через emplace
+template<typename StructureT, typename BuildT>
+void measure_lifetime(benchmark::State &state, Allocation allocation, size_t pool_block_size, BuildT build) {
+  typedef std::chrono::steady_clock Clock;
+  double build_ns = 0;
+  double teardown_ns = 0;
+  for (auto _ : state) {
+    auto begin = Clock::now();
+    std::optional<BenchResource> resource(std::in_place, allocation, pool_block_size);
+    std::optional<StructureT> structure;
+    build(&structure, resource->get());
+    auto built = Clock::now();
+    structure.reset();
+    resource.reset();
+    auto destroyed = Clock::now();
+    build_ns += std::chrono::duration<double, std::nano>(built - begin).count();
+    teardown_ns += std::chrono::duration<double, std::nano>(destroyed - built).count();
+  }
+  state.counters["build"] = benchmark::Counter(build_ns, benchmark::Counter::kAvgIterations);
+  state.counters["teardown"] = benchmark::Counter(teardown_ns, benchmark::Counter::kAvgIterations);
+}
@@ -0,0 +1,150 @@
+// Синтетические входные данные для бенчмарков. Генераторы детерминированы:
+// один и тот же размер всегда даёт одни и те же данные, результаты разных запусков сравнимы
+#pragma once
+
+#include <vector>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+
+const uint32_t WorkloadSeed = 2019;
+
+// равномерно распределённые числа во всём диапазоне int
+inline std::vector<int> random_ints(int n) {
+  std::mt19937 random(WorkloadSeed);
+  std::vector<int> result(n);
+  for (auto &value : result) value = static_cast<int>(random());
+  return result;
+}
+
+// Порядок входных данных для сортировки и выбора: кроме случайного, случаи, на которых
+// алгоритмы с неудачным выбором опорного элемента или разбиением на прогоны ведут себя иначе
+enum class IntPattern {
+  Random,
+  Sorted,
+  Reversed,
+  // всего 16 различных значений в случайном порядке
+  FewUnique,
+  AllEqual,
+  // возрастает до середины, затем убывает
+  OrganPipe,
+  // последовательность Массера, на которой медиана трёх (первый, средний, последний) каждый раз
+  // отделяет от отрезка всего пару элементов; n должно быть чётным
+  MedianOfThreeKiller
+};
+
+inline std::vector<int> patterned_ints(int n, IntPattern pattern) {
+  std::mt19937 random(WorkloadSeed);
+  std::vector<int> result(n);
+  switch (pattern) {
+    case IntPattern::Random:
+      for (auto &value : result) value = static_cast<int>(random());
+      break;
+    case IntPattern::Sorted:
+      for (int i = 0; i < n; ++i) result[i] = i;
+      break;
+    case IntPattern::Reversed:
+      for (int i = 0; i < n; ++i) result[i] = n - i;
+      break;
+    case IntPattern::FewUnique:
+      for (auto &value : result) value = static_cast<int>(random() % 16);
+      break;
+    case IntPattern::AllEqual:
+      std::fill(result.begin(), result.end(), 1);
+      break;
+    case IntPattern::OrganPipe:
+      for (int i = 0; i < n; ++i) result[i] = std::min(i, n - 1 - i);
+      break;
+    case IntPattern::MedianOfThreeKiller:
+      for (int i = 1; i <= n / 2; ++i) {
+        if (i % 2 == 1) {
+          result[i - 1] = i;
+          result[i] = n / 2 + i;
+        }
+        result[n / 2 + i - 1] = 2 * i;
+      }
+      break;
+  }
+  return result;
+}
+
+// перестановка чисел 0..n-1
+inline std::vector<int> random_permutation(int n) {
+  std::mt19937 random(WorkloadSeed);
+  std::vector<int> result(n);
+  for (int i = 0; i < n; ++i) result[i] = i;
+  std::shuffle(result.begin(), result.end(), random);
+  return result;
+}
+
+// Ключи с распределением Ципфа: ключ ранга r из universe различных встречается с частотой ~ 1 / r^exponent,
+// так что несколько горячих ключей покрывают большую часть входа. Ранги перемешаны по значениям,
+// чтобы горячие ключи не шли подряд в порядке сравнения
+inline std::vector<int> zipf_ints(int n, int universe, double exponent) {
+  std::mt19937 random(WorkloadSeed);
+  std::vector<double> cumulative(universe);
+  double total = 0;
+  for (int rank = 0; rank < universe; ++rank) {
+    total += 1 / std::pow(rank + 1.0, exponent);
+    cumulative[rank] = total;
+  }
+  std::vector<int> keys(universe);
+  for (int i = 0; i < universe; ++i) keys[i] = i;
+  std::shuffle(keys.begin(), keys.end(), random);
+  std::uniform_real_distribution<double> uniform(0, total);
+  std::vector<int> result(n);
+  for (auto &value : result) {
+    auto rank = std::lower_bound(cumulative.begin(), cumulative.end(), uniform(random)) - cumulative.begin();
+    value = keys[std::min<size_t>(rank, universe - 1)];
+  }
+  return result;
+}
+
+// строки из строчных латинских букв длины от 1 до max_length
+inline std::vector<std::string> random_words(int n, int max_length) {
+  std::mt19937 random(WorkloadSeed);
+  std::uniform_int_distribution<int> length(1, max_length);
+  std::uniform_int_distribution<int> letter('a', 'z');
+  std::vector<std::string> result(n);
+  for (auto &word : result) {
+    word.resize(length(random));
+    for (auto &c : word) c = static_cast<char>(letter(random));
+  }
+  return result;
+}
+
+// текст с геометрическим распределением байтов: частые символы встречаются
+// намного чаще редких, как в обычном тексте, и кодам Хаффмана есть что сжимать
+inline std::vector<unsigned char> skewed_bytes(int n) {
+  std::mt19937 random(WorkloadSeed);
+  std::geometric_distribution<int> symbol(0.08);
+  std::vector<unsigned char> result(n);
+  for (auto &value : result) value = static_cast<unsigned char>('a' + symbol(random) % 64);
+  return result;
+}
+
+// случайный неориентированный граф в формате конструктора SimpleGraph: плоский массив пар (from, to)
+inline std::vector<int> random_graph_edges(int n_vertexes, int n_edges) {
+  std::mt19937 random(WorkloadSeed);
+  std::uniform_int_distribution<int> vertex(0, n_vertexes - 1);
+  std::vector<int> result(2 * static_cast<size_t>(n_edges));
+  for (auto &value : result) value = vertex(random);
+  return result;
+}
+
+// квадратная решётка side x side в том же формате: вершина (row, column) имеет номер row * side + column
+// и соединена с правой и нижней соседкой. Кратчайших путей из угла в угол C(2 side - 2, side - 1)
+inline std::vector<int> grid_graph_edges(int side) {
+  std::vector<int> result;
+  result.reserve(4 * static_cast<size_t>(side) * side);
+  for (int row = 0; row < side; ++row) {
+    for (int column = 0; column < side; ++column) {
+      int vertex = row * side + column;
+      if (column + 1 < side) result.insert(result.end(), {vertex, vertex + 1});
+      if (row + 1 < side) result.insert(result.end(), {vertex, vertex + side});
+    }
+  }
+  return result;
+}
@@ -0,0 +1,292 @@
+/*
+ Быстрый ввод и вывод целых чисел для решений задач.
+ InputReader отображает stdin в память, если это обычный файл, иначе читает его большими блоками.
+ Числа разбираются по 8 цифр за раз (SWAR), без локалей и синхронизации со stdio.
+ OutputWriter копит вывод в буфере и сбрасывает его в stdout одним вызовом.
+ MappedFile отображает файл в память целиком.
+*/
+#pragma once
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+class InputReader {
+ public:
+  InputReader();
+  // разбор уже загруженного в память отрезка, например куска MappedFile
+  InputReader(const char *data, size_t size);
+  ~InputReader();
+  InputReader(const InputReader &) = delete;
+  InputReader(InputReader &&) = delete;
+  InputReader &operator=(const InputReader &) = delete;
+  InputReader &operator=(InputReader &&) = delete;
+  // возвращает false, если входные данные закончились или очередная лексема не число,
+  // в этом случае value не меняется. Перед числом допускается знак '-' или '+'
+  template<typename IntT>
+  bool read_int(IntT *value);
+  template<typename IntT>
+  IntT read_int();
+  // после неудачного read_int отличает конец ввода (остались только пробельные символы)
+  // от лексемы, которая не является числом
+  bool at_end();
+ private:
+  static const size_t buffer_size = 1 << 16;
+  char *buffer = nullptr;
+  const char *position = nullptr;
+  const char *end = nullptr;
+  const char *mapped = nullptr;
+  size_t mapped_size = 0;
+  // read_int встретил лексему, которая не число; дальше чтение не продолжается
+  bool invalid = false;
+  bool refill();
+  bool skip_spaces();
+  static bool is_eight_digits(uint64_t chunk);
+  static uint32_t parse_eight_digits(uint64_t chunk);
+};
+
+inline InputReader::InputReader() {
+#if defined(__unix__) || defined(__APPLE__)
+  struct stat info{};
+  if (fstat(STDIN_FILENO, &info) == 0 and S_ISREG(info.st_mode) and info.st_size > 0) {
+    void *data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, STDIN_FILENO, 0);
+    if (data != MAP_FAILED) {
+      madvise(data, info.st_size, MADV_SEQUENTIAL);
+      mapped = static_cast<const char *>(data);
+      mapped_size = info.st_size;
+      position = mapped;
+      end = mapped + mapped_size;
+      return;
+    }
+  }
+#endif
+  buffer = new char[buffer_size];
+  position = buffer;
+  end = buffer;
+}
+
+inline InputReader::InputReader(const char *data, size_t size) {
+  position = data;
+  end = data + size;
+}
+
+inline InputReader::~InputReader() {
+#if defined(__unix__) || defined(__APPLE__)
+  if (mapped != nullptr) munmap(const_cast<char *>(mapped), mapped_size);
+#endif
+  delete[] buffer;
+}
+
+inline bool InputReader::refill() {
+  if (buffer == nullptr) return false;
+  size_t read = fread(buffer, 1, buffer_size, stdin);
+  position = buffer;
+  end = buffer + read;
+  return read != 0;
+}
+
+inline bool InputReader::skip_spaces() {
+  while (true) {
+    while (position < end and static_cast<unsigned char>(*position) <= ' ') ++position;
+    if (position < end) return true;
+    if (!refill()) return false;
+  }
+}
+
+// все 8 байт - цифры: старшие полубайты равны 3, и прибавление 6 не даёт переноса
+inline bool InputReader::is_eight_digits(uint64_t chunk) {
+  return ((chunk & 0xF0F0F0F0F0F0F0F0ull) |
+      (((chunk + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4)) == 0x3333333333333333ull;
+}
+
+// собираем соседние цифры попарно: 8 цифр -> 4 числа до 100 -> 2 числа до 10^4 -> результат,
+// первая цифра лежит в младшем байте (little-endian)
+inline uint32_t InputReader::parse_eight_digits(uint64_t chunk) {
+  chunk -= 0x3030303030303030ull;
+  chunk = (chunk * 10 + (chunk >> 8)) & 0x00FF00FF00FF00FFull;
+  chunk = (chunk * 100 + (chunk >> 16)) & 0x0000FFFF0000FFFFull;
+  chunk = (chunk * 10000 + (chunk >> 32)) & 0x00000000FFFFFFFFull;
+  return static_cast<uint32_t>(chunk);
+}
+
+template<typename IntT>
+bool InputReader::read_int(IntT *value) {
+  if (invalid or !skip_spaces()) return false;
+  bool negative = *position == '-';
+  if (negative or *position == '+') ++position;
+  uint64_t result = 0;
+  bool has_digits = false;
+  while (true) {
+    const char *block_start = position;
+    // быстрый путь: в буфере ещё есть 8 цифр подряд
+    uint64_t chunk;
+    while (end - position >= 8) {
+      std::memcpy(&chunk, position, 8);
+      if (!is_eight_digits(chunk)) break;
+      result = result * 100000000 + parse_eight_digits(chunk);
+      position += 8;
+    }
+    unsigned digit;
+    while (position < end and (digit = static_cast<unsigned char>(*position) - '0') < 10) {
+      result = result * 10 + digit;
+      ++position;
+    }
+    has_digits |= position != block_start;
+    // число может продолжаться в следующем блоке
+    if (position < end or !refill()) break;
+  }
+  if (!has_digits) {
+    // не число (например, буква или знак без цифр): запоминаем, чтобы at_end не принял это за конец ввода
+    invalid = true;
+    return false;
+  }
+  *value = negative ? static_cast<IntT>(0 - result) : static_cast<IntT>(result);
+  return true;
+}
+
+template<typename IntT>
+IntT InputReader::read_int() {
+  IntT value = 0;
+  read_int(&value);
+  return value;
+}
+
+inline bool InputReader::at_end() {
+  return !invalid and !skip_spaces();
+}
+
+class OutputWriter {
+ public:
+  OutputWriter() = default;
+  ~OutputWriter();
+  OutputWriter(const OutputWriter &) = delete;
+  OutputWriter(OutputWriter &&) = delete;
+  OutputWriter &operator=(const OutputWriter &) = delete;
+  OutputWriter &operator=(OutputWriter &&) = delete;
+  template<typename IntT>
+  void write_int(IntT value);
+  void write_char(char c);
+  void write_string(const char *s);
+  void flush();
+ private:
+  static const size_t buffer_size = 1 << 16;
+  char buffer[buffer_size];
+  size_t size = 0;
+};
+
+inline OutputWriter::~OutputWriter() {
+  flush();
+}
+
+inline void OutputWriter::flush() {
+  fwrite(buffer, 1, size, stdout);
+  fflush(stdout);
+  size = 0;
+}
+
+inline void OutputWriter::write_char(char c) {
+  if (size == buffer_size) flush();
+  buffer[size++] = c;
+}
+
+inline void OutputWriter::write_string(const char *s) {
+  while (*s != '\0') write_char(*s++);
+}
+
+template<typename IntT>
+void OutputWriter::write_int(IntT value) {
+  // самое длинное 64-битное число со знаком занимает 20 символов
+  if (buffer_size - size < 24) flush();
+  uint64_t absolute = static_cast<uint64_t>(value);
+  if (value < 0) {
+    buffer[size++] = '-';
+    absolute = 0 - absolute;
+  }
+  char digits[20];
+  int length = 0;
+  do {
+    digits[length++] = static_cast<char>('0' + absolute % 10);
+    absolute /= 10;
+  } while (absolute != 0);
+  while (length > 0) buffer[size++] = digits[--length];
+}
+
+class MappedFile {
+ public:
+  explicit MappedFile(const char *path);
+  ~MappedFile();
+  MappedFile(const MappedFile &) = delete;
+  MappedFile(MappedFile &&) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  MappedFile &operator=(MappedFile &&) = delete;
+  bool is_open() const;
+  const char *data() const;
+  size_t size() const;
+ private:
+  const char *file_data = nullptr;
+  size_t file_size = 0;
+  bool opened = false;
+  // если отобразить файл не удалось, он читается в обычный буфер
+  char *buffer = nullptr;
+};
+
+inline MappedFile::MappedFile(const char *path) {
+#if defined(__unix__) || defined(__APPLE__)
+  int fd = open(path, O_RDONLY);
+  if (fd >= 0) {
+    struct stat info{};
+    if (fstat(fd, &info) == 0) {
+      opened = true;
+      file_size = info.st_size;
+      if (file_size > 0) {
+        void *data = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+          madvise(data, file_size, MADV_SEQUENTIAL);
+          file_data = static_cast<const char *>(data);
+        } else {
+          opened = false;
+        }
+      }
+    }
+    close(fd);
+    if (opened) return;
+  }
+#endif
+  FILE *file = fopen(path, "rb");
+  if (file == nullptr) return;
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  if (size > 0) {
+    buffer = new char[size];
+    file_size = fread(buffer, 1, size, file);
+    file_data = buffer;
+  }
+  opened = true;
+  fclose(file);
+}
+
+inline MappedFile::~MappedFile() {
+#if defined(__unix__) || defined(__APPLE__)
+  if (buffer == nullptr and file_data != nullptr) munmap(const_cast<char *>(file_data), file_size);
+#endif
+  delete[] buffer;
+}
+
+inline bool MappedFile::is_open() const {
+  return opened;
+}
+
+inline const char *MappedFile::data() const {
+  return file_data;
+}
+
+inline size_t MappedFile::size() const {
+  return file_size;
+}
@@ -0,0 +1,201 @@
+/*
+ Источники памяти для структур из вершин (std::pmr::memory_resource).
+ MonotonicArena выдаёт память подряд из больших кусков и ничего не освобождает по одному:
+ удаление вершин бесплатно, вся память возвращается разом при release() или в деструкторе.
+ FixedSizePool выдаёт блоки одного размера и переиспользует освобождённые через список свободных,
+ подходит для структур, которые долго живут и много удаляют.
+ Оба не потокобезопасны, как std::pmr::unsynchronized_pool_resource.
+*/
+#pragma once
+
+#include <memory_resource>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+class MonotonicArena : public std::pmr::memory_resource {
+ public:
+  explicit MonotonicArena(size_t chunk_size = 4096,
+                          std::pmr::memory_resource *upstream = std::pmr::get_default_resource());
+  // сначала память берётся из buffer, он должен жить дольше арены
+  MonotonicArena(void *buffer, size_t size, std::pmr::memory_resource *upstream = std::pmr::get_default_resource());
+  ~MonotonicArena() override;
+  MonotonicArena(const MonotonicArena &) = delete;
+  MonotonicArena(MonotonicArena &&) = delete;
+  MonotonicArena &operator=(const MonotonicArena &) = delete;
+  MonotonicArena &operator=(MonotonicArena &&) = delete;
+  // возвращает все куски upstream, после этого арену можно использовать заново
+  void release();
+  // сколько байт выдано с последнего release
+  size_t used() const;
+ private:
+  struct Chunk {
+    Chunk *next;
+    size_t size;
+  };
+  std::pmr::memory_resource *upstream;
+  Chunk *chunks = nullptr;
+  char *initial_buffer = nullptr;
+  size_t initial_size = 0;
+  char *current = nullptr;
+  char *end = nullptr;
+  size_t first_chunk_size;
+  size_t next_chunk_size;
+  size_t used_bytes = 0;
+  void add_chunk(size_t min_size);
+  void *do_allocate(size_t bytes, size_t alignment) override;
+  void do_deallocate(void *pointer, size_t bytes, size_t alignment) override;
+  bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+};
+
+inline MonotonicArena::MonotonicArena(size_t chunk_size, std::pmr::memory_resource *upstream)
+    : upstream(upstream), first_chunk_size(std::max(chunk_size, 2 * sizeof(Chunk))),
+      next_chunk_size(first_chunk_size) {}
+
+inline MonotonicArena::MonotonicArena(void *buffer, size_t size, std::pmr::memory_resource *upstream)
+    : MonotonicArena(std::max<size_t>(size, 4096), upstream) {
+  initial_buffer = static_cast<char *>(buffer);
+  initial_size = size;
+  current = initial_buffer;
+  end = initial_buffer + initial_size;
+}
+
+inline MonotonicArena::~MonotonicArena() {
+  release();
+}
+
+inline void MonotonicArena::release() {
+  while (chunks != nullptr) {
+    Chunk *next = chunks->next;
+    upstream->deallocate(chunks, chunks->size, alignof(std::max_align_t));
+    chunks = next;
+  }
+  current = initial_buffer;
+  end = initial_buffer + initial_size;
+  next_chunk_size = first_chunk_size;
+  used_bytes = 0;
+}
+
+inline size_t MonotonicArena::used() const {
+  return used_bytes;
+}
+
+// куски растут вдвое, так что на n байт приходится O(log n) обращений к upstream
+inline void MonotonicArena::add_chunk(size_t min_size) {
+  size_t size = std::max(next_chunk_size, min_size + sizeof(Chunk));
+  auto chunk = static_cast<Chunk *>(upstream->allocate(size, alignof(std::max_align_t)));
+  chunk->next = chunks;
+  chunk->size = size;
+  chunks = chunk;
+  current = reinterpret_cast<char *>(chunk + 1);
+  end = reinterpret_cast<char *>(chunk) + size;
+  next_chunk_size = 2 * size;
+}
+
+inline void *MonotonicArena::do_allocate(size_t bytes, size_t alignment) {
+  auto aligned = (reinterpret_cast<uintptr_t>(current) + alignment - 1) & ~(alignment - 1);
+  if (current == nullptr or aligned + bytes > reinterpret_cast<uintptr_t>(end)) {
+    add_chunk(bytes + alignment);
+    aligned = (reinterpret_cast<uintptr_t>(current) + alignment - 1) & ~(alignment - 1);
+  }
+  current = reinterpret_cast<char *>(aligned + bytes);
+  used_bytes += bytes;
+  return reinterpret_cast<void *>(aligned);
+}
+
+inline void MonotonicArena::do_deallocate(void *, size_t, size_t) {}
+
+inline bool MonotonicArena::do_is_equal(const std::pmr::memory_resource &other) const noexcept {
+  return this == &other;
+}
+
+// Блоки размера block_size нарезаются из кусков по blocks_per_chunk штук.
+// Запросы большего размера или выравнивания уходят в upstream
+class FixedSizePool : public std::pmr::memory_resource {
+ public:
+  explicit FixedSizePool(size_t block_size, size_t blocks_per_chunk = 1024,
+                         std::pmr::memory_resource *upstream = std::pmr::get_default_resource());
+  ~FixedSizePool() override;
+  FixedSizePool(const FixedSizePool &) = delete;
+  FixedSizePool(FixedSizePool &&) = delete;
+  FixedSizePool &operator=(const FixedSizePool &) = delete;
+  FixedSizePool &operator=(FixedSizePool &&) = delete;
+  size_t block_size() const;
+ private:
+  struct FreeBlock {
+    FreeBlock *next;
+  };
+  struct Chunk {
+    Chunk *next;
+    // заголовок занимает целое число блоков выравнивания, блоки после него выровнены
+    alignas(std::max_align_t) char blocks[1];
+  };
+  std::pmr::memory_resource *upstream;
+  size_t block;
+  size_t blocks_per_chunk;
+  Chunk *chunks = nullptr;
+  FreeBlock *free_blocks = nullptr;
+  bool fits(size_t bytes, size_t alignment) const;
+  void add_chunk();
+  void *do_allocate(size_t bytes, size_t alignment) override;
+  void do_deallocate(void *pointer, size_t bytes, size_t alignment) override;
+  bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+};
+
+// размер блока округляется вверх до кратного alignof(max_align_t), чтобы все блоки были выровнены
+inline FixedSizePool::FixedSizePool(size_t block_size, size_t blocks_per_chunk, std::pmr::memory_resource *upstream)
+    : upstream(upstream), blocks_per_chunk(std::max<size_t>(blocks_per_chunk, 1)) {
+  const size_t align = alignof(std::max_align_t);
+  block = (std::max(block_size, sizeof(FreeBlock)) + align - 1) / align * align;
+}
+
+inline FixedSizePool::~FixedSizePool() {
+  while (chunks != nullptr) {
+    Chunk *next = chunks->next;
+    upstream->deallocate(chunks, offsetof(Chunk, blocks) + block * blocks_per_chunk, alignof(std::max_align_t));
+    chunks = next;
+  }
+}
+
+inline size_t FixedSizePool::block_size() const {
+  return block;
+}
+
+inline bool FixedSizePool::fits(size_t bytes, size_t alignment) const {
+  return bytes <= block and alignment <= alignof(std::max_align_t);
+}
+
+// новый кусок целиком раскладывается в список свободных блоков
+inline void FixedSizePool::add_chunk() {
+  auto chunk = static_cast<Chunk *>(upstream->allocate(offsetof(Chunk, blocks) + block * blocks_per_chunk,
+                                                       alignof(std::max_align_t)));
+  chunk->next = chunks;
+  chunks = chunk;
+  for (size_t i = blocks_per_chunk; i > 0; --i) {
+    auto free_block = reinterpret_cast<FreeBlock *>(chunk->blocks + (i - 1) * block);
+    free_block->next = free_blocks;
+    free_blocks = free_block;
+  }
+}
+
+inline void *FixedSizePool::do_allocate(size_t bytes, size_t alignment) {
+  if (!fits(bytes, alignment)) return upstream->allocate(bytes, alignment);
+  if (free_blocks == nullptr) add_chunk();
+  FreeBlock *result = free_blocks;
+  free_blocks = result->next;
+  return result;
+}
+
+inline void FixedSizePool::do_deallocate(void *pointer, size_t bytes, size_t alignment) {
+  if (!fits(bytes, alignment)) {
+    upstream->deallocate(pointer, bytes, alignment);
+    return;
+  }
+  auto free_block = static_cast<FreeBlock *>(pointer);
+  free_block->next = free_blocks;
+  free_blocks = free_block;
+}
+
+inline bool FixedSizePool::do_is_equal(const std::pmr::memory_resource &other) const noexcept {
+  return this == &other;
+}
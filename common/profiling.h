@@ -0,0 +1,228 @@
+/*
+ Профилирование именованных участков кода.
+ PROFILE_REGION("name") в начале блока замеряет время до конца блока, а на Linux ещё и аппаратные счётчики
+ (такты, инструкции, промахи кеша, ошибки предсказания переходов) через perf_event_open.
+ Без -DALGO_PROFILE макрос раскрывается в пустой оператор и ничего не стоит.
+ С ним при завершении программы в stderr печатается отчёт по участкам: число входов, время и счётчики.
+ Участки с одним именем из разных мест и потоков суммируются, вложенные участки считаются включительно.
+ Счётчики, которые ядро не даёт открыть (виртуальная машина, perf_event_paranoid), в отчёте помечены "-".
+*/
+#pragma once
+
+#ifdef ALGO_PROFILE
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+enum ProfileCounter {
+  ProfileCycles,
+  ProfileInstructions,
+  ProfileCacheMisses,
+  ProfileBranchMisses,
+  ProfileCountersSize
+};
+
+struct ProfileRegion {
+  explicit ProfileRegion(const char *name) : name(name) {}
+  const char *name;
+  std::atomic<uint64_t> calls{0};
+  std::atomic<uint64_t> nanoseconds{0};
+  std::atomic<uint64_t> counters[ProfileCountersSize]{};
+};
+
+// Все участки программы, печатает отчёт в деструкторе
+class ProfileRegistry {
+ public:
+  static ProfileRegistry &instance();
+  ~ProfileRegistry();
+  ProfileRegistry(const ProfileRegistry &) = delete;
+  ProfileRegistry(ProfileRegistry &&) = delete;
+  ProfileRegistry &operator=(const ProfileRegistry &) = delete;
+  ProfileRegistry &operator=(ProfileRegistry &&) = delete;
+  // вызывается один раз на место в коде, поэтому поиск линейный
+  ProfileRegion *region(const char *name);
+  // какие счётчики удалось открыть хотя бы в одном потоке
+  void mark_available(int counter);
+ private:
+  ProfileRegistry() = default;
+  std::mutex mutex;
+  std::deque<ProfileRegion> regions;
+  std::atomic<bool> available[ProfileCountersSize]{};
+};
+
+inline ProfileRegistry &ProfileRegistry::instance() {
+  static ProfileRegistry registry;
+  return registry;
+}
+
+inline ProfileRegion *ProfileRegistry::region(const char *name) {
+  std::lock_guard<std::mutex> lock(mutex);
+  for (auto &region : regions) {
+    if (std::strcmp(region.name, name) == 0) return &region;
+  }
+  regions.emplace_back(name);
+  return &regions.back();
+}
+
+inline void ProfileRegistry::mark_available(int counter) {
+  available[counter].store(true, std::memory_order_relaxed);
+}
+
+inline ProfileRegistry::~ProfileRegistry() {
+  static const char *const counter_names[ProfileCountersSize] = {"cycles", "instructions", "cache-misses",
+                                                                 "branch-misses"};
+  if (regions.empty()) return;
+  // решения часто не заканчивают вывод переводом строки, отчёт начинаем с новой строки
+  fflush(stdout);
+  fprintf(stderr, "\n%-28s %10s %12s %12s", "region", "calls", "total ms", "ns/call");
+  for (auto name : counter_names) fprintf(stderr, " %14s", name);
+  fprintf(stderr, " %6s\n", "IPC");
+  for (auto &region : regions) {
+    uint64_t calls = region.calls.load();
+    uint64_t nanoseconds = region.nanoseconds.load();
+    fprintf(stderr, "%-28s %10llu %12.3f %12.1f", region.name, static_cast<unsigned long long>(calls),
+            nanoseconds / 1e6, calls == 0 ? 0.0 : static_cast<double>(nanoseconds) / calls);
+    for (int i = 0; i < ProfileCountersSize; ++i) {
+      if (available[i]) {
+        fprintf(stderr, " %14llu", static_cast<unsigned long long>(region.counters[i].load()));
+      } else {
+        fprintf(stderr, " %14s", "-");
+      }
+    }
+    uint64_t cycles = region.counters[ProfileCycles].load();
+    if (available[ProfileCycles] and available[ProfileInstructions] and cycles != 0) {
+      fprintf(stderr, " %6.2f\n", static_cast<double>(region.counters[ProfileInstructions].load()) / cycles);
+    } else {
+      fprintf(stderr, " %6s\n", "-");
+    }
+  }
+}
+
+// Счётчики текущего потока: одна группа perf_event, читается одним системным вызовом.
+// Недоступные события пропускаются, values для них остаются нулями
+class ProfileThreadCounters {
+ public:
+  static ProfileThreadCounters &instance();
+  ~ProfileThreadCounters();
+  ProfileThreadCounters(const ProfileThreadCounters &) = delete;
+  ProfileThreadCounters(ProfileThreadCounters &&) = delete;
+  ProfileThreadCounters &operator=(const ProfileThreadCounters &) = delete;
+  ProfileThreadCounters &operator=(ProfileThreadCounters &&) = delete;
+  void read(uint64_t *values) const;
+ private:
+  ProfileThreadCounters();
+  int leader = -1;
+  int descriptors[ProfileCountersSize];
+  // номер счётчика для каждого открытого события, в порядке их значений в группе
+  int order[ProfileCountersSize];
+  int opened = 0;
+};
+
+inline ProfileThreadCounters &ProfileThreadCounters::instance() {
+  thread_local ProfileThreadCounters counters;
+  return counters;
+}
+
+inline ProfileThreadCounters::ProfileThreadCounters() {
+#if defined(__linux__)
+  static const uint64_t configs[ProfileCountersSize] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                                        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+  for (int i = 0; i < ProfileCountersSize; ++i) {
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = configs[i];
+    attr.disabled = leader == -1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    // только текущий поток, на любом процессоре
+    int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0));
+    descriptors[i] = fd;
+    if (fd < 0) continue;
+    if (leader == -1) leader = fd;
+    order[opened++] = i;
+    ProfileRegistry::instance().mark_available(i);
+  }
+  if (leader != -1) {
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+#else
+  for (int &fd : descriptors) fd = -1;
+#endif
+}
+
+inline ProfileThreadCounters::~ProfileThreadCounters() {
+#if defined(__linux__)
+  for (int fd : descriptors) {
+    if (fd >= 0) close(fd);
+  }
+#endif
+}
+
+inline void ProfileThreadCounters::read(uint64_t *values) const {
+  for (int i = 0; i < ProfileCountersSize; ++i) values[i] = 0;
+#if defined(__linux__)
+  if (leader == -1) return;
+  // формат группы: количество событий, затем их значения
+  uint64_t group[1 + ProfileCountersSize];
+  if (::read(leader, group, sizeof(group)) < static_cast<ssize_t>(sizeof(uint64_t) * (1 + opened))) return;
+  for (int i = 0; i < opened; ++i) values[order[i]] = group[1 + i];
+#endif
+}
+
+class ProfileScope {
+ public:
+  explicit ProfileScope(ProfileRegion *region);
+  ~ProfileScope();
+  ProfileScope(const ProfileScope &) = delete;
+  ProfileScope(ProfileScope &&) = delete;
+  ProfileScope &operator=(const ProfileScope &) = delete;
+  ProfileScope &operator=(ProfileScope &&) = delete;
+ private:
+  ProfileRegion *region;
+  uint64_t start_counters[ProfileCountersSize];
+  std::chrono::steady_clock::time_point start;
+};
+
+inline ProfileScope::ProfileScope(ProfileRegion *region) : region(region) {
+  ProfileThreadCounters::instance().read(start_counters);
+  start = std::chrono::steady_clock::now();
+}
+
+inline ProfileScope::~ProfileScope() {
+  auto finish = std::chrono::steady_clock::now();
+  uint64_t finish_counters[ProfileCountersSize];
+  ProfileThreadCounters::instance().read(finish_counters);
+  region->calls.fetch_add(1, std::memory_order_relaxed);
+  region->nanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(finish - start).count(),
+                                std::memory_order_relaxed);
+  for (int i = 0; i < ProfileCountersSize; ++i) {
+    region->counters[i].fetch_add(finish_counters[i] - start_counters[i], std::memory_order_relaxed);
+  }
+}
+
+#define PROFILE_CONCAT_(first, second) first##second
+#define PROFILE_CONCAT(first, second) PROFILE_CONCAT_(first, second)
+// участок регистрируется при первом проходе через это место, дальше вход стоит двух чтений счётчиков
+#define PROFILE_REGION(name) \
+  static ProfileRegion *const PROFILE_CONCAT(profile_region_, __LINE__) = ProfileRegistry::instance().region(name); \
+  ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)(PROFILE_CONCAT(profile_region_, __LINE__))
+
+#else
+
+#define PROFILE_REGION(name) static_cast<void>(0)
+
+#endif
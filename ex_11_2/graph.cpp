@@ -0,0 +1,210 @@
+#include "graph.h"
+#include <cstdio>
+#include <cstring>
+
+SimpleGraph::SimpleGraph(int n_vertexes, const std::vector<int> &edges) {
+  this->n_vertexes = n_vertexes;
+  offsets_storage.assign(n_vertexes + 1, 0);
+  for (int vertex : edges) {
+    ++offsets_storage[vertex + 1];
+  }
+  for (int i = 0; i < n_vertexes; ++i) {
+    offsets_storage[i + 1] += offsets_storage[i];
+  }
+  // граф неориентированный, каждое ребро попадает в списки обоих концов
+  targets_storage.resize(edges.size());
+  std::vector<int64_t> position(offsets_storage.begin(), offsets_storage.end() - 1);
+  for (size_t i = 0; i + 1 < edges.size(); i += 2) {
+    int from = edges[i];
+    int to = edges[i + 1];
+    targets_storage[position[from]++] = to;
+    targets_storage[position[to]++] = from;
+  }
+  offsets = offsets_storage.data();
+  targets = targets_storage.data();
+}
+
+SimpleGraph::SimpleGraph(const SimpleGraph &graph, const std::vector<int> &order) {
+  n_vertexes = graph.size();
+  std::vector<int> new_vertex(n_vertexes);
+  for (int i = 0; i < n_vertexes; ++i) {
+    new_vertex[order[i]] = i;
+  }
+  offsets_storage.assign(n_vertexes + 1, 0);
+  for (int i = 0; i < n_vertexes; ++i) {
+    offsets_storage[i + 1] = offsets_storage[i] + graph.degree(order[i]);
+  }
+  targets_storage.resize(offsets_storage[n_vertexes]);
+  for (int i = 0; i < n_vertexes; ++i) {
+    int *target = targets_storage.data() + offsets_storage[i];
+    for (const int *neighbor = graph.neighbors_begin(order[i]); neighbor != graph.neighbors_end(order[i]); ++neighbor) {
+      *target++ = new_vertex[*neighbor];
+    }
+    // соседи по возрастанию номеров обходятся почти последовательно
+    std::sort(targets_storage.data() + offsets_storage[i], target);
+  }
+  labels_storage.resize(n_vertexes);
+  for (int original = 0; original < n_vertexes; ++original) {
+    labels_storage[original] = new_vertex[graph.vertex(original)];
+  }
+  offsets = offsets_storage.data();
+  targets = targets_storage.data();
+  labels = labels_storage.data();
+}
+
+// Один линейный проход по массивам файла: смещения не убывают, соседи и метки - номера вершин,
+// метки образуют перестановку. Без этого испорченный файл подходящего размера приводит к чтению
+// за пределами массивов при обходе
+static bool is_valid_csr(int64_t n_vertexes, const int64_t *offsets, int64_t n_targets, const int *targets,
+                         const int *labels) {
+  if (offsets[0] != 0 or offsets[n_vertexes] != n_targets) return false;
+  for (int64_t v = 0; v < n_vertexes; ++v) {
+    if (offsets[v] > offsets[v + 1]) return false;
+  }
+  for (int64_t i = 0; i < n_targets; ++i) {
+    if (targets[i] < 0 or targets[i] >= n_vertexes) return false;
+  }
+  if (labels == nullptr) return true;
+  std::vector<bool> used(n_vertexes, false);
+  for (int64_t v = 0; v < n_vertexes; ++v) {
+    if (labels[v] < 0 or labels[v] >= n_vertexes or used[labels[v]]) return false;
+    used[labels[v]] = true;
+  }
+  return true;
+}
+
+SimpleGraph::SimpleGraph(const char *path) {
+  file = new MappedFile(path);
+  GraphFileHeader header{};
+  if (!file->is_open() or file->size() < sizeof(header)) return;
+  std::memcpy(&header, file->data(), sizeof(header));
+  if (std::memcmp(header.magic, GraphFileMagic, sizeof(GraphFileMagic)) != 0 or header.version != GraphFileVersion or
+      (header.flags & ~GraphFileHasLabels) != 0 or header.n_vertexes < 0 or header.n_vertexes >= INT32_MAX or
+      header.n_targets < 0 or static_cast<uint64_t>(header.n_targets) > file->size() / sizeof(int)) {
+    return;
+  }
+  bool has_labels = (header.flags & GraphFileHasLabels) != 0;
+  uint64_t expected_size = sizeof(header) + (header.n_vertexes + 1) * sizeof(int64_t) + header.n_targets * sizeof(int) +
+      (has_labels ? header.n_vertexes * sizeof(int) : 0);
+  if (file->size() != expected_size) return;
+  // заголовок занимает 32 байта, так что массивы в отображении выровнены
+  const int64_t *file_offsets = reinterpret_cast<const int64_t *>(file->data() + sizeof(header));
+  const int *file_targets = reinterpret_cast<const int *>(file_offsets + header.n_vertexes + 1);
+  const int *file_labels = has_labels ? file_targets + header.n_targets : nullptr;
+  if (!is_valid_csr(header.n_vertexes, file_offsets, header.n_targets, file_targets, file_labels)) return;
+  n_vertexes = static_cast<int>(header.n_vertexes);
+  offsets = file_offsets;
+  targets = file_targets;
+  labels = file_labels;
+}
+
+SimpleGraph::~SimpleGraph() {
+  delete file;
+}
+
+bool SimpleGraph::is_loaded() const {
+  return offsets != nullptr;
+}
+
+bool SimpleGraph::save(const char *path) const {
+  FILE *output = fopen(path, "wb");
+  if (output == nullptr) return false;
+  GraphFileHeader header{};
+  std::memcpy(header.magic, GraphFileMagic, sizeof(GraphFileMagic));
+  header.version = GraphFileVersion;
+  header.flags = labels != nullptr ? GraphFileHasLabels : 0;
+  header.n_vertexes = n_vertexes;
+  header.n_targets = offsets[n_vertexes];
+  bool written = fwrite(&header, sizeof(header), 1, output) == 1 and
+      fwrite(offsets, sizeof(int64_t), n_vertexes + 1, output) == static_cast<size_t>(n_vertexes) + 1 and
+      (header.n_targets == 0 or
+       fwrite(targets, sizeof(int), header.n_targets, output) == static_cast<size_t>(header.n_targets)) and
+      (labels == nullptr or fwrite(labels, sizeof(int), n_vertexes, output) == static_cast<size_t>(n_vertexes));
+  return fclose(output) == 0 and written;
+}
+
+int SimpleGraph::size() const {
+  return n_vertexes;
+}
+
+int SimpleGraph::vertex(int original) const {
+  return labels != nullptr ? labels[original] : original;
+}
+
+int SimpleGraph::degree(int vertex) const {
+  return static_cast<int>(offsets[vertex + 1] - offsets[vertex]);
+}
+
+const int *SimpleGraph::neighbors_begin(int vertex) const {
+  return targets + offsets[vertex];
+}
+
+const int *SimpleGraph::neighbors_end(int vertex) const {
+  return targets + offsets[vertex + 1];
+}
+
+std::vector<int> degree_order(const SimpleGraph &graph) {
+  std::vector<int> order(graph.size());
+  for (int i = 0; i < graph.size(); ++i) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [&graph](int first, int second) {
+    return graph.degree(first) > graph.degree(second);
+  });
+  return order;
+}
+
+std::vector<int> cuthill_mckee_order(const SimpleGraph &graph) {
+  int n = graph.size();
+  std::vector<int> by_degree(n);
+  for (int i = 0; i < n; ++i) {
+    by_degree[i] = i;
+  }
+  auto less_degree = [&graph](int first, int second) { return graph.degree(first) < graph.degree(second); };
+  std::stable_sort(by_degree.begin(), by_degree.end(), less_degree);
+  std::vector<bool> visited(n, false);
+  std::vector<int> order;
+  order.reserve(n);
+  for (int start : by_degree) {
+    if (visited[start]) continue;
+    visited[start] = true;
+    order.push_back(start);
+    for (size_t head = order.size() - 1; head < order.size(); ++head) {
+      size_t level_begin = order.size();
+      int curr_element = order[head];
+      const int *neighbors_end = graph.neighbors_end(curr_element);
+      for (const int *vertex = graph.neighbors_begin(curr_element); vertex != neighbors_end; ++vertex) {
+        if (!visited[*vertex]) {
+          visited[*vertex] = true;
+          order.push_back(*vertex);
+        }
+      }
+      std::stable_sort(order.begin() + level_begin, order.end(), less_degree);
+    }
+  }
+  std::reverse(order.begin(), order.end());
+  return order;
+}
+
+void write_path_count(uint64_t count, OutputWriter *writer) {
+  writer->write_int(count);
+}
+
+void write_path_count(unsigned __int128 count, OutputWriter *writer) {
+  const uint64_t base = 10000000000000000000ull;
+  if (count >= base) {
+    write_path_count(count / base, writer);
+    // младшая часть дополняется нулями до 19 цифр
+    uint64_t low = static_cast<uint64_t>(count % base);
+    for (uint64_t power = base / 10; power > 1 and low < power; power /= 10) {
+      writer->write_char('0');
+    }
+    writer->write_int(low);
+  } else {
+    writer->write_int(static_cast<uint64_t>(count));
+  }
+}
+
+void write_path_count(const BigCount &count, OutputWriter *writer) {
+  writer->write_string(count.to_string().c_str());
+}
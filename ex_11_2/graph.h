@@ -0,0 +1,494 @@
+// Граф в формате CSR и подсчёт количества кратчайших путей в нём: последовательный, встречный,
+// пакетный и параллельный обходы в ширину
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <cstdint>
+#include <cstring>
+#include "../common/fast_io.h"
+#include "../common/profiling.h"
+
+// Заголовок бинарного файла графа. За ним идут offsets (n_vertexes + 1 чисел int64),
+// targets (n_targets чисел int32) и, если установлен флаг GraphFileHasLabels, labels (n_vertexes чисел int32)
+// в порядке байт машины, на которой файл записан
+struct GraphFileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t flags;
+  int64_t n_vertexes;
+  int64_t n_targets;
+};
+
+const char GraphFileMagic[8] = {'C', 'S', 'R', 'G', 'R', 'A', 'P', 'H'};
+const uint32_t GraphFileVersion = 1;
+const uint32_t GraphFileHasLabels = 1;
+
+// Граф хранится в сжатом виде (CSR): соседи вершины v лежат в targets[offsets[v], offsets[v + 1]),
+// списки всех вершин идут подряд в одном массиве. Массивы либо строятся из списка рёбер,
+// либо без разбора берутся из отображённого в память бинарного файла.
+// Вершины могут быть перенумерованы для локальности обхода, тогда labels переводит исходный номер
+// вершины в номер в графе
+class SimpleGraph {
+ public:
+  // edges - плоский массив пар (from, to); граф строится за два прохода:
+  // сначала считаются степени вершин, затем рёбра раскладываются по своим местам
+  SimpleGraph(int n_vertexes, const std::vector<int> &edges);
+  // копия graph, в которой вершина order[i] получает номер i
+  SimpleGraph(const SimpleGraph &graph, const std::vector<int> &order);
+  // загружает файл, записанный save; если файл не подходит, is_loaded() вернёт false
+  explicit SimpleGraph(const char *path);
+  ~SimpleGraph();
+  SimpleGraph(const SimpleGraph &) = delete;
+  SimpleGraph(SimpleGraph &&) = delete;
+  SimpleGraph &operator=(const SimpleGraph &) = delete;
+  SimpleGraph &operator=(SimpleGraph &&) = delete;
+  bool is_loaded() const;
+  bool save(const char *path) const;
+  int size() const;
+  // номер в графе вершины с исходным номером original
+  int vertex(int original) const;
+  int degree(int vertex) const;
+  const int *neighbors_begin(int vertex) const;
+  const int *neighbors_end(int vertex) const;
+ private:
+  int n_vertexes = 0;
+  const int64_t *offsets = nullptr;
+  const int *targets = nullptr;
+  const int *labels = nullptr;
+  // память графа, построенного из списка рёбер
+  std::vector<int64_t> offsets_storage;
+  std::vector<int> targets_storage;
+  std::vector<int> labels_storage;
+  MappedFile *file = nullptr;
+};
+
+// Перенумерации вершин для локальности обхода: order[i] - исходная вершина, которая получит номер i.
+// По убыванию степени: вершины-хабы, через которые проходит большинство обходов, лежат рядом
+std::vector<int> degree_order(const SimpleGraph &graph);
+
+// Обратный порядок Катхилла-Макки: обход в ширину каждой компоненты из вершины наименьшей степени,
+// соседи добавляются по возрастанию степени, итоговый порядок разворачивается.
+// Соседние вершины получают близкие номера, и фронт обхода занимает узкую полосу массивов
+std::vector<int> cuthill_mckee_order(const SimpleGraph &graph);
+
+// Количество путей быстро растёт (на решётке - экспоненциально), поэтому его тип выбирается при компиляции:
+// по умолчанию 64 бита, -DPATH_COUNT_128 - 128 бит, -DPATH_COUNT_BIG - длинная арифметика,
+// -DPATH_COUNT_MODULO=p - остаток по модулю простого p < 2^31
+
+template<uint32_t Modulus>
+class ModularCount {
+ public:
+  static_assert(Modulus < (1u << 31), "sum of two residues must fit into 32 bits");
+  ModularCount(uint32_t value = 0) : value(value % Modulus) {}
+  ModularCount &operator+=(const ModularCount &other) {
+    value += other.value;
+    // если value < Modulus, разность переполняется и оказывается больше
+    value = std::min(value, value - Modulus);
+    return *this;
+  }
+  friend ModularCount operator*(const ModularCount &first, const ModularCount &second) {
+    return ModularCount(static_cast<uint32_t>(static_cast<uint64_t>(first.value) * second.value % Modulus));
+  }
+  uint32_t get() const {
+    return value;
+  }
+ private:
+  uint32_t value;
+};
+
+// Неотрицательное число произвольной длины в 64-битных разрядах, младший разряд первый.
+// Сложение идёт на месте, память выделяется только когда число становится длиннее
+class BigCount {
+ public:
+  BigCount(uint64_t value = 0) {
+    if (value != 0) limbs.push_back(value);
+  }
+  BigCount &operator+=(const BigCount &other) {
+    if (limbs.size() < other.limbs.size()) limbs.resize(other.limbs.size(), 0);
+    uint64_t carry = 0;
+    for (size_t i = 0; i < other.limbs.size(); ++i) {
+      uint64_t sum = limbs[i] + carry;
+      carry = sum < carry;
+      sum += other.limbs[i];
+      carry += sum < other.limbs[i];
+      limbs[i] = sum;
+    }
+    for (size_t i = other.limbs.size(); carry != 0 and i < limbs.size(); ++i) {
+      carry = ++limbs[i] == 0;
+    }
+    if (carry != 0) limbs.push_back(carry);
+    return *this;
+  }
+  // умножение в столбик по 32-битным половинам разрядов; нужно только при встрече двух обходов
+  friend BigCount operator*(const BigCount &first, const BigCount &second) {
+    std::vector<uint32_t> a = first.halves();
+    std::vector<uint32_t> b = second.halves();
+    std::vector<uint32_t> product(a.size() + b.size(), 0);
+    for (size_t i = 0; i < a.size(); ++i) {
+      uint64_t carry = 0;
+      for (size_t j = 0; j < b.size(); ++j) {
+        // (2^32 - 1)^2 + 2 * (2^32 - 1) помещается в 64 бита
+        uint64_t current = static_cast<uint64_t>(a[i]) * b[j] + product[i + j] + carry;
+        product[i + j] = static_cast<uint32_t>(current);
+        carry = current >> 32;
+      }
+      product[i + b.size()] = static_cast<uint32_t>(carry);
+    }
+    BigCount result;
+    for (size_t i = 0; i < product.size(); i += 2) {
+      uint64_t high = i + 1 < product.size() ? product[i + 1] : 0;
+      result.limbs.push_back(product[i] | high << 32);
+    }
+    while (!result.limbs.empty() and result.limbs.back() == 0) result.limbs.pop_back();
+    return result;
+  }
+  // десятичная запись; делим на 10^9 по 32-битным половинам разрядов, чтобы хватало 64-битной арифметики
+  std::string to_string() const {
+    std::vector<uint32_t> halves = this->halves();
+    std::string digits;
+    while (!halves.empty()) {
+      uint64_t remainder = 0;
+      for (size_t i = halves.size(); i-- > 0;) {
+        uint64_t current = (remainder << 32) | halves[i];
+        halves[i] = static_cast<uint32_t>(current / 1000000000);
+        remainder = current % 1000000000;
+      }
+      while (!halves.empty() and halves.back() == 0) halves.pop_back();
+      for (int i = 0; i < 9 and (!halves.empty() or remainder != 0); ++i) {
+        digits.push_back(static_cast<char>('0' + remainder % 10));
+        remainder /= 10;
+      }
+    }
+    if (digits.empty()) digits.push_back('0');
+    std::reverse(digits.begin(), digits.end());
+    return digits;
+  }
+ private:
+  std::vector<uint64_t> limbs;
+  // разряды по 32 бита без старших нулей
+  std::vector<uint32_t> halves() const {
+    std::vector<uint32_t> result;
+    for (uint64_t limb : limbs) {
+      result.push_back(static_cast<uint32_t>(limb));
+      result.push_back(static_cast<uint32_t>(limb >> 32));
+    }
+    while (!result.empty() and result.back() == 0) result.pop_back();
+    return result;
+  }
+};
+
+#if defined(PATH_COUNT_MODULO)
+typedef ModularCount<PATH_COUNT_MODULO> PathCount;
+#elif defined(PATH_COUNT_BIG)
+typedef BigCount PathCount;
+#elif defined(PATH_COUNT_128)
+typedef unsigned __int128 PathCount;
+#else
+typedef uint64_t PathCount;
+#endif
+
+void write_path_count(uint64_t count, OutputWriter *writer);
+void write_path_count(unsigned __int128 count, OutputWriter *writer);
+void write_path_count(const BigCount &count, OutputWriter *writer);
+
+template<uint32_t Modulus>
+void write_path_count(const ModularCount<Modulus> &count, OutputWriter *writer) {
+  writer->write_int(count.get());
+}
+
+// Состояние обхода в ширину хранится отдельно от графа и переиспользуется между запросами.
+// Вершина считается посещённой, только если её метка равна номеру текущего обхода,
+// поэтому перед новым обходом массивы не очищаются
+template<typename PathCountT>
+struct BfsState {
+  explicit BfsState(int n) : stamp(n, 0), path_len(n), n_paths(n), queue(n) {}
+  void reset() {
+    // раз в 2^32 обходов метки могут совпасть со старыми, тогда они всё же обнуляются
+    if (++generation == 0) {
+      std::fill(stamp.begin(), stamp.end(), 0);
+      generation = 1;
+    }
+    head = 0;
+    tail = 0;
+  }
+  bool is_visited(int vertex) const {
+    return stamp[vertex] == generation;
+  }
+  void visit(int vertex, int len) {
+    stamp[vertex] = generation;
+    path_len[vertex] = len;
+    n_paths[vertex] = PathCountT(0);
+    queue[tail++] = vertex;
+  }
+  // обрабатывает очередную вершину из очереди, добавляя её соседей на следующий уровень
+  void expand(const SimpleGraph &graph, int curr_element) {
+    int next_len = path_len[curr_element] + 1;
+    const int *neighbors_end = graph.neighbors_end(curr_element);
+    for (const int *vertex = graph.neighbors_begin(curr_element); vertex != neighbors_end; ++vertex) {
+      if (!is_visited(*vertex)) {
+        // длина пути до потомков больше длины путей до родителей на 1
+        visit(*vertex, next_len);
+      }
+      // кратчайшие пути в потомка продолжают кратчайшие пути во все его вершины-родители
+      if (path_len[*vertex] == next_len) {
+        n_paths[*vertex] += n_paths[curr_element];
+      }
+    }
+  }
+
+  std::vector<uint32_t> stamp;
+  uint32_t generation = 0;
+  // длина пути до вершины
+  std::vector<int> path_len;
+  // количество путей в вершину, при обходе в ширину будет
+  // являться количеством кротчайших путей
+  std::vector<PathCountT> n_paths;
+  // каждая вершина попадает в очередь не больше одного раза, поэтому хватает массива на n элементов;
+  // [head, tail) - ещё не обработанные вершины
+  std::vector<int> queue;
+  int head = 0;
+  int tail = 0;
+};
+
+template<typename PathCountT>
+PathCountT shortest_paths_quantity(const SimpleGraph &graph, int from, int to, BfsState<PathCountT> *state) {
+  PROFILE_REGION("bfs.serial");
+  state->reset();
+  state->visit(from, 0);
+  state->n_paths[from] = 1;
+  while (state->head < state->tail) {
+    int curr_element = state->queue[state->head++];
+    // все вершины предыдущего уровня уже обработаны, количество путей до curr_element окончательно
+    if (curr_element == to) break;
+    state->expand(graph, curr_element);
+  }
+  return state->is_visited(to) ? state->n_paths[to] : PathCountT(0);
+}
+
+template<typename PathCountT>
+PathCountT shortest_paths_quantity(const SimpleGraph &graph, int from, int to) {
+  BfsState<PathCountT> state(graph.size());
+  return shortest_paths_quantity(graph, from, to, &state);
+}
+
+// Встречный обход: по очереди целиком раскрывается уровень той стороны, у которой фронт меньше.
+// Пусть раскрыт уровень L одной стороны, а у другой стороны последний уровень - M, и до этого посещённые
+// вершины сторон не пересекались. Тогда кратчайший путь не короче L + M, а каждая вершина нового уровня,
+// посещённая другой стороной, лежит на пути длины L + M. Каждый кратчайший путь проходит ровно через одну
+// такую вершину, так что ответ - сумма произведений количеств путей в неё с обеих сторон
+template<typename PathCountT>
+PathCountT bidirectional_shortest_paths_quantity(const SimpleGraph &graph, int from, int to,
+                                                 BfsState<PathCountT> *forward, BfsState<PathCountT> *backward) {
+  if (from == to) return PathCountT(1);
+  PROFILE_REGION("bfs.bidirectional");
+  forward->reset();
+  backward->reset();
+  forward->visit(from, 0);
+  forward->n_paths[from] = 1;
+  backward->visit(to, 0);
+  backward->n_paths[to] = 1;
+  while (forward->head < forward->tail and backward->head < backward->tail) {
+    BfsState<PathCountT> *side = forward;
+    BfsState<PathCountT> *other = backward;
+    if (backward->tail - backward->head < forward->tail - forward->head) std::swap(side, other);
+    int level_begin = side->tail;
+    while (side->head < level_begin) {
+      side->expand(graph, side->queue[side->head++]);
+    }
+    PathCountT total(0);
+    bool met = false;
+    for (int i = level_begin; i < side->tail; ++i) {
+      int vertex = side->queue[i];
+      if (other->is_visited(vertex)) {
+        total += side->n_paths[vertex] * other->n_paths[vertex];
+        met = true;
+      }
+    }
+    if (met) return total;
+  }
+  return PathCountT(0);
+}
+
+// Много запросов к одному графу: потоки берут запросы из общей очереди, у каждого потока
+// свои состояния обходов, которые переиспользуются между запросами
+template<typename PathCountT>
+std::vector<PathCountT> batch_shortest_paths_quantity(const SimpleGraph &graph,
+                                                      const std::vector<std::pair<int, int>> &queries, int threads) {
+  std::vector<PathCountT> answers(queries.size(), PathCountT(0));
+  std::atomic<size_t> next_query(0);
+  auto worker = [&]() {
+    BfsState<PathCountT> forward(graph.size());
+    BfsState<PathCountT> backward(graph.size());
+    for (size_t i = next_query++; i < queries.size(); i = next_query++) {
+      answers[i] = bidirectional_shortest_paths_quantity(graph, queries[i].first, queries[i].second,
+                                                         &forward, &backward);
+    }
+  };
+  threads = std::max(1, std::min(threads, static_cast<int>(queries.size())));
+  std::vector<std::thread> workers;
+  for (int thread = 1; thread < threads; ++thread) {
+    workers.emplace_back(worker);
+  }
+  worker();
+  for (auto &thread : workers) thread.join();
+  return answers;
+}
+
+// Барьер для потоков, обходящих граф по уровням
+class LevelBarrier {
+ public:
+  explicit LevelBarrier(int threads) : threads(threads) {}
+  void wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    int current = generation;
+    if (++arrived == threads) {
+      arrived = 0;
+      ++generation;
+      all_arrived.notify_all();
+    } else {
+      all_arrived.wait(lock, [&]() { return generation != current; });
+    }
+  }
+ private:
+  int threads;
+  int arrived = 0;
+  int generation = 0;
+  std::mutex mutex;
+  std::condition_variable all_arrived;
+};
+
+// меньше этого числа вершин параллельный обход не окупается
+const int ParallelBfsSize = 1 << 16;
+// переход к обходу снизу вверх, когда рёбер у фронта больше, чем 1 / BottomUpAlpha от ещё не просмотренных
+const int BottomUpAlpha = 15;
+// возврат к обходу сверху вниз, когда во фронте меньше 1 / TopDownBeta от всех вершин
+const int TopDownBeta = 18;
+// столько вершин поток забирает из общей очереди за раз
+const int BfsChunkSize = 1024;
+
+// Параллельный обход в ширину по уровням. Сверху вниз потоки раздают вершинам фронта номер следующего уровня
+// (CAS по path_len), снизу вверх каждая непосещённая вершина ищет соседей во фронте сама; направление
+// выбирается по размеру фронта. Количество путей в вершину уровня d - сумма по её соседям уровня d - 1,
+// её считает один поток после того, как уровень d - 1 закончен, поэтому сумма не зависит от порядка обхода
+// и совпадает с последовательной версией
+template<typename PathCountT>
+PathCountT parallel_shortest_paths_quantity(const SimpleGraph &graph, int from, int to, int threads) {
+  int n = graph.size();
+  if (threads < 2 or n < ParallelBfsSize) return shortest_paths_quantity<PathCountT>(graph, from, to);
+  if (from == to) return PathCountT(1);
+
+  std::vector<std::atomic<int>> path_len(n);
+  for (auto &len : path_len) len.store(-1, std::memory_order_relaxed);
+  std::vector<PathCountT> n_paths(n, PathCountT(0));
+  path_len[from].store(0, std::memory_order_relaxed);
+  n_paths[from] = 1;
+
+  std::vector<int> frontier(1, from);
+  std::vector<std::vector<int>> next(threads);
+  std::vector<int64_t> next_edges(threads);
+  int64_t unexplored_edges = 0;
+  for (int v = 0; v < n; ++v) unexplored_edges += graph.degree(v);
+  unexplored_edges -= graph.degree(from);
+  int64_t frontier_edges = graph.degree(from);
+  bool top_down = true;
+  bool done = false;
+  int level = 0;
+  std::atomic<int64_t> cursor(0);
+  LevelBarrier barrier(threads);
+
+  // сумма путей по соседям уровня level
+  auto count_paths = [&](int vertex, bool *found) {
+    PathCountT paths(0);
+    const int *neighbors_end = graph.neighbors_end(vertex);
+    for (const int *parent = graph.neighbors_begin(vertex); parent != neighbors_end; ++parent) {
+      if (path_len[*parent].load(std::memory_order_relaxed) == level) {
+        paths += n_paths[*parent];
+        *found = true;
+      }
+    }
+    return paths;
+  };
+
+  auto worker = [&](int thread) {
+    PROFILE_REGION("bfs.parallel");
+    std::vector<int> &local = next[thread];
+    while (true) {
+      int64_t edges = 0;
+      if (top_down) {
+        int64_t size = frontier.size();
+        for (int64_t start = cursor.fetch_add(BfsChunkSize); start < size; start = cursor.fetch_add(BfsChunkSize)) {
+          for (int64_t i = start; i < std::min(size, start + BfsChunkSize); ++i) {
+            const int *neighbors_end = graph.neighbors_end(frontier[i]);
+            for (const int *vertex = graph.neighbors_begin(frontier[i]); vertex != neighbors_end; ++vertex) {
+              int unvisited = -1;
+              if (path_len[*vertex].load(std::memory_order_relaxed) < 0 and
+                  path_len[*vertex].compare_exchange_strong(unvisited, level + 1, std::memory_order_relaxed)) {
+                local.push_back(*vertex);
+              }
+            }
+          }
+        }
+        barrier.wait();
+        // все вершины нового уровня отмечены, каждый поток считает пути для найденных им вершин
+        for (int vertex : local) {
+          bool found = false;
+          n_paths[vertex] = count_paths(vertex, &found);
+          edges += graph.degree(vertex);
+        }
+      } else {
+        for (int64_t start = cursor.fetch_add(BfsChunkSize); start < n; start = cursor.fetch_add(BfsChunkSize)) {
+          for (int vertex = static_cast<int>(start); vertex < std::min<int64_t>(n, start + BfsChunkSize); ++vertex) {
+            if (path_len[vertex].load(std::memory_order_relaxed) >= 0) continue;
+            // для подсчёта путей просматриваются все соседи, а не только до первого найденного во фронте
+            bool found = false;
+            PathCountT paths = count_paths(vertex, &found);
+            if (found) {
+              // соседи сравнивают path_len с level, а новое значение level + 1, поэтому гонки здесь нет
+              path_len[vertex].store(level + 1, std::memory_order_relaxed);
+              n_paths[vertex] = std::move(paths);
+              local.push_back(vertex);
+              edges += graph.degree(vertex);
+            }
+          }
+        }
+      }
+      next_edges[thread] = edges;
+      barrier.wait();
+      if (thread == 0) {
+        frontier.clear();
+        frontier_edges = 0;
+        for (int i = 0; i < threads; ++i) {
+          frontier.insert(frontier.end(), next[i].begin(), next[i].end());
+          next[i].clear();
+          frontier_edges += next_edges[i];
+        }
+        unexplored_edges -= frontier_edges;
+        ++level;
+        done = frontier.empty() or path_len[to].load(std::memory_order_relaxed) >= 0;
+        if (top_down and frontier_edges > unexplored_edges / BottomUpAlpha) {
+          top_down = false;
+        } else if (!top_down and static_cast<int64_t>(frontier.size()) < n / TopDownBeta) {
+          top_down = true;
+        }
+        cursor.store(0);
+      }
+      barrier.wait();
+      if (done) break;
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (int thread = 1; thread < threads; ++thread) {
+    workers.emplace_back(worker, thread);
+  }
+  worker(0);
+  for (auto &thread : workers) thread.join();
+  return n_paths[to];
+}
@@ -2,93 +2,117 @@
  Дан невзвешенный неориентированный граф. В графе может быть несколько кратчайших путей между какими-то вершинами.
  Найдите количество различных кратчайших путей между заданными вершинами. Требуемая сложность O(V+E).
 */
-#include <iostream>
 #include <vector>
-#include <queue>
-#include <set>
+#include <utility>
+#include <thread>
+#include <cstdio>
+#include <cstring>
+#include "graph.h"
+#include "../common/fast_io.h"
 
-struct Node {
-  // количество путей в вершину, при обходе в ширину будет
-  // являться количеством кротчайших путей
-  int n_paths;
-  // длина пути в текущую вершину
-  int path_len;
-  std::vector<int> neighbors;
-};
-
-class SimpleGraph {
- public:
-  explicit SimpleGraph(int n) {
-    this->table = new std::vector<Node>();
-    table->resize(n);
-    for (int i = 0; i < n; ++i) {
-      table->at(i) = Node{0, 0, std::vector<int>()};
+// Без аргументов граф в текстовом виде и запросы читаются из stdin. Аргументы:
+// --graph graph.bin - граф загружается из бинарного файла, в stdin только запросы;
+// --reorder degree|rcm - вершины перенумеровываются для локальности, запросы и ответы не меняются;
+// --convert graph.bin - граф (после перенумерации) сохраняется в бинарный файл, запросы не читаются
+int main(int argc, char **argv) {
+  const char *graph_path = nullptr;
+  const char *convert_path = nullptr;
+  const char *reorder = nullptr;
+  for (int arg = 1; arg < argc; ++arg) {
+    bool has_value = arg + 1 < argc;
+    if (has_value and std::strcmp(argv[arg], "--graph") == 0) {
+      graph_path = argv[++arg];
+    } else if (has_value and std::strcmp(argv[arg], "--convert") == 0) {
+      convert_path = argv[++arg];
+    } else if (has_value and std::strcmp(argv[arg], "--reorder") == 0 and
+        (std::strcmp(argv[arg + 1], "degree") == 0 or std::strcmp(argv[arg + 1], "rcm") == 0)) {
+      reorder = argv[++arg];
+    } else {
+      fprintf(stderr, "usage: %s [--graph graph.bin] [--reorder degree|rcm] [--convert graph.bin]\n", argv[0]);
+      return 1;
     }
   }
-  ~SimpleGraph() {
-    delete table;
-  }
-  SimpleGraph(const SimpleGraph &) = delete;
-  SimpleGraph(SimpleGraph &&) = delete;
-  SimpleGraph &operator=(const SimpleGraph &) = delete;
-  SimpleGraph &operator=(SimpleGraph &&) = delete;
-  void add_route(int from, int to);
-  Node *at(int value) const;
- private:
-  std::vector<Node> *table;
-};
-
-void SimpleGraph::add_route(int from, int to) {
-  table->at(from).neighbors.push_back(to);
-  table->at(to).neighbors.push_back(from);
-}
-Node *SimpleGraph::at(int value) const {
-  return &table->at(value);
-}
 
-int shortest_paths_quantity(SimpleGraph *graph, int from, int to) {
-  auto q = std::queue<int>();
-  auto visited = std::set<int>();
-  graph->at(from)->path_len = 0;
-  graph->at(from)->n_paths = 1;
-  visited.insert(from);
-  q.push(from);
-  int curr_element;
-  do {
-    curr_element = q.front();
-    q.pop();
-
-    for (int vertex: graph->at(curr_element)->neighbors) {
-      if (!visited.count(vertex)) {
-        q.push(vertex);
-        // длина пути до потомков больше длины путей до родителей на 1
-        graph->at(vertex)->path_len = graph->at(curr_element)->path_len + 1;
-        visited.insert(vertex);
-      } else {
-        // если дочерняя вершина уже посещена и находится на уровень выше текущей,
-        // то добавляем количество путей до неё к количеству путей до текущей вершины
-        if (graph->at(vertex)->path_len < graph->at(curr_element)->path_len) {
-          graph->at(curr_element)->n_paths += graph->at(vertex)->n_paths;
-        }
+  InputReader reader;
+  OutputWriter writer;
+  SimpleGraph *graph = nullptr;
+  if (graph_path != nullptr) {
+    graph = new SimpleGraph(graph_path);
+    if (!graph->is_loaded()) {
+      fprintf(stderr, "cannot load graph from %s\n", graph_path);
+      delete graph;
+      return 1;
+    }
+  } else {
+    int n_vertexes = 0;
+    int n_edges = 0;
+    if (!reader.read_int(&n_vertexes) or !reader.read_int(&n_edges) or n_vertexes < 0 or n_edges < 0) {
+      fprintf(stderr, "expected vertex and edge counts\n");
+      return 1;
+    }
+    std::vector<int> edges(2 * static_cast<size_t>(n_edges));
+    for (int &vertex : edges) {
+      if (!reader.read_int(&vertex)) {
+        fprintf(stderr, "expected %d edges\n", n_edges);
+        return 1;
+      }
+      if (vertex < 0 or vertex >= n_vertexes) {
+        fprintf(stderr, "edge vertex %d is out of range [0, %d)\n", vertex, n_vertexes);
+        return 1;
       }
     }
-  } while (curr_element != to and !q.empty());
-  return graph->at(to)->n_paths;
-}
-
-int main() {
-  int n_vertexes, n_edges;
-  std::cin >> n_vertexes >> n_edges;
-  auto graph = new SimpleGraph(n_vertexes);
-  for (int i = 0; i < n_edges; ++i) {
-    int from, to;
-    std::cin >> from >> to;
-    graph->add_route(from, to);
+    graph = new SimpleGraph(n_vertexes, edges);
+  }
+  if (reorder != nullptr) {
+    std::vector<int> order = std::strcmp(reorder, "degree") == 0 ? degree_order(*graph) : cuthill_mckee_order(*graph);
+    auto reordered = new SimpleGraph(*graph, order);
+    delete graph;
+    graph = reordered;
+  }
+  if (convert_path != nullptr) {
+    bool saved = graph->save(convert_path);
+    delete graph;
+    if (!saved) {
+      fprintf(stderr, "cannot write %s\n", convert_path);
+      return 1;
+    }
+    return 0;
   }
 
-  int from, to;
-  std::cin >> from >> to;
-  std::cout << shortest_paths_quantity(graph, from, to);
+  // после графа идёт один или несколько запросов (from, to), на каждый выводится ответ
+  std::vector<std::pair<int, int>> queries;
+  int from = 0;
+  int to = 0;
+  while (reader.read_int(&from)) {
+    if (!reader.read_int(&to)) {
+      fprintf(stderr, reader.at_end() ? "query has no second vertex\n" : "queries must contain only integers\n");
+      delete graph;
+      return 1;
+    }
+    // в исходной версии номера проверял vector::at, vertex() их не проверяет
+    if (from < 0 or from >= graph->size() or to < 0 or to >= graph->size()) {
+      fprintf(stderr, "query vertex is out of range [0, %d)\n", graph->size());
+      delete graph;
+      return 1;
+    }
+    queries.emplace_back(graph->vertex(from), graph->vertex(to));
+  }
+  if (!reader.at_end()) {
+    fprintf(stderr, "queries must contain only integers\n");
+    delete graph;
+    return 1;
+  }
+  int threads = static_cast<int>(std::thread::hardware_concurrency());
+  if (queries.size() == 1) {
+    // для одного запроса параллелится сам обход
+    write_path_count(parallel_shortest_paths_quantity<PathCount>(*graph, queries[0].first, queries[0].second, threads),
+                     &writer);
+  } else {
+    for (const PathCount &answer : batch_shortest_paths_quantity<PathCount>(*graph, queries, threads)) {
+      write_path_count(answer, &writer);
+      writer.write_char('\n');
+    }
+  }
   delete graph;
   return 0;
 }
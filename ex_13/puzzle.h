@@ -0,0 +1,59 @@
+// Позиция игры в пятнашки и поиск решения алгоритмом A*
+#pragma once
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <queue>
+#include <unordered_map>
+#include <memory_resource>
+#include <functional>
+#include <cassert>
+
+const size_t HashParameter = 37;
+const int BoardSize = 16;
+
+// фишки хранятся в самой позиции: копии позиций в очереди и словарях A* не выделяют память
+struct position {
+  std::array<char, BoardSize> chips;
+  char zero_place;
+
+  bool is_finish() const;
+  bool is_correct() const;
+  std::vector<position> siblings() const;
+
+  bool operator==(const position &other) const;
+  bool operator!=(const position &other) const { return !operator==(other); }
+  int count_evristic();
+};
+
+namespace std {
+template<>
+struct hash<position> {
+  size_t operator()(const position &key) const {
+    size_t value = 0;
+    for (auto chip : key.chips) {
+      value = HashParameter * value + static_cast<size_t>(chip);
+    }
+    return value;
+  }
+};
+}
+
+extern const position finish_position;
+
+// предок каждой пройденной позиции
+typedef std::pmr::unordered_map<position, position> ParentsMap;
+
+char get_move_symbol(const position &from, const position &to);
+
+// ищет путь от start до finish_position, для каждой пройденной позиции запоминает предка;
+// расстояния до позиций хранятся в том же источнике памяти, что и parents
+bool a_star(const position &start, ParentsMap &parents);
+
+std::vector<char> get_path(const position &start, const ParentsMap &parents);
+
+// возвращает false, если решение не найдено, иначе последовательность ходов.
+// Словари пройденных позиций выделяются из resource, например из MonotonicArena
+std::pair<bool, std::vector<char>> solve_barley_break(
+    const position &start, std::pmr::memory_resource *resource = std::pmr::get_default_resource());
@@ -2,107 +2,84 @@
   Требуется вывести в отсортированном виде её наименьшие k элементов.
   Последовательность может не помещаться в память.
   Время работы O(n * log(k)). Доп. память O(k). Использовать слияние. */
-#include <iostream>
+#include <deque>
+#include <thread>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "top_k.h"
+#include "../common/fast_io.h"
 
-template<typename T, typename CompareT>
-void merge(T *arr, int start, int mid, int end, CompareT compare) {
-  if (start == end) {
-    return;
-  }
-  int i = start;
-  int j = mid;
-  int k = 0;
-  T *result = new T[end - start];
-
-  while ((i < mid) and (j < end)) {
-    if (compare(arr[i], arr[j])) {
-      result[k] = arr[i];
-      ++i;
-    } else {
-      result[k] = arr[j];
-      ++j;
+// Без аргументов n, k и последовательность читаются из stdin.
+// main [--binary] [--threads t] k file... ищет k наименьших среди всех чисел из файлов:
+// текстовые файлы содержат только числа через пробельные символы, бинарные - подряд идущие int32
+int main(int argc, char **argv) {
+  if (argc > 1) {
+    bool binary = false;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    int arg = 1;
+    for (; arg < argc and argv[arg][0] == '-'; ++arg) {
+      if (std::strcmp(argv[arg], "--binary") == 0) {
+        binary = true;
+      } else if (std::strcmp(argv[arg], "--threads") == 0 and arg + 1 < argc) {
+        threads = std::max(1, std::atoi(argv[++arg]));
+      } else {
+        break;
+      }
     }
-    ++k;
-  }
-
-  while (i < mid) {
-    result[k] = arr[i];
-    ++i;
-    ++k;
-  }
-
-  while (j < end) {
-    result[k] = arr[j];
-    ++j;
-    ++k;
-  }
-
-  for (int m = start; m < end; ++m) {
-    arr[m] = result[m - start];
-  }
-  delete[] result;
-}
-
-// k - указывает на начало части массива, которая будет отсортирована
-template<typename T, typename CompareT>
-void merge_sort(T *arr, int n, int k, CompareT compare) {
-  for (int i = 1; i < n; i *= 2) {
-    for (int j = k; j < n - i; j += 2 * i) {
-      int end = j + 2 * i;
-      if (end > n) {
-        end = n;
+    if (argc - arg < 2) {
+      fprintf(stderr, "usage: %s [--binary] [--threads t] k file...\n", argv[0]);
+      return 1;
+    }
+    int k = std::atoi(argv[arg++]);
+    if (k <= 0) {
+      fprintf(stderr, "k must be positive\n");
+      return 1;
+    }
+    std::deque<MappedFile> files;
+    for (; arg < argc; ++arg) {
+      files.emplace_back(argv[arg]);
+      if (!files.back().is_open()) {
+        fprintf(stderr, "cannot open %s\n", argv[arg]);
+        return 1;
       }
-      merge(arr, j, j + i, end, compare);
     }
+    OutputWriter writer;
+    std::vector<int> result;
+    if (!top_k_from_files<int>(files, binary, k, ComparerLess<int>(), threads, &result)) {
+      fprintf(stderr, "input files must contain only integers\n");
+      return 1;
+    }
+    print_array(result.data(), static_cast<int>(result.size()), &writer);
+    return 0;
   }
-}
-
-template<typename T>
-void print_array(T *arr, int n) {
-  for (int i = 0; i < n; ++i) {
-    std::cout << arr[i] << ' ';
-  }
-}
 
-template<typename T>
-class ComparerLess {
- public:
-  bool operator()(T &first, T &second) const;
-};
-template<typename T>
-bool ComparerLess<T>::operator()(T &first, T &second) const {
-  return first < second;
-}
-
-int main() {
-  int n, k;
-  std::cin >> n >> k;
-  int arr_size = 2 * k;
-  int *input_array = new int[arr_size];
-  int sequence_length = 0;
-
-  ComparerLess<int> comparer = ComparerLess<int>();
-
-  for (int i = 0; i < k; ++i) {
-    std::cin >> input_array[i];
-    ++sequence_length;
+  InputReader reader;
+  OutputWriter writer;
+  int n = 0;
+  int k = 0;
+  if (!reader.read_int(&n) or !reader.read_int(&k) or n < 0 or k <= 0) {
+    fprintf(stderr, "expected n >= 0 and k > 0\n");
+    return 1;
   }
-  merge_sort(input_array, k, 0, comparer);
+  MergeTopK<int, ComparerLess<int>> top_k(k, ComparerLess<int>());
 
-  // пока есть что сичтывать
-  while (sequence_length < n) {
-    int i;
-    // заполняем вторую половину массива
-    for (i = k; i < arr_size and sequence_length < n; ++i) {
-      std::cin >> input_array[i];
-      ++sequence_length;
+  // читаем блоками, чтобы отбрасывать элементы больше порога пачками
+  const int block_size = 4096;
+  int block[block_size];
+  for (int read = 0; read < n;) {
+    int count = std::min(block_size, n - read);
+    for (int i = 0; i < count; ++i) {
+      if (!reader.read_int(&block[i])) {
+        fprintf(stderr, "expected %d values\n", n);
+        return 1;
+      }
     }
-    // как только заполнится, сортируем её и мержим с первой половиной
-    merge_sort(input_array, i, k, comparer);
-    merge(input_array, 0, k, i, comparer);
+    top_k.add_block(block, count);
+    read += count;
   }
 
-  print_array(input_array, k);
-  delete[] input_array;
+  auto result = top_k.result();
+  print_array(result.data(), static_cast<int>(result.size()), &writer);
   return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,513 @@
+// Поиск k наименьших элементов последовательности: слияние отсортированных блоков (MergeTopK),
+// ограниченная куча, отбор через quickselect и параллельный режим для данных из файлов
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <queue>
+#include <algorithm>
+#include <utility>
+#include <atomic>
+#include <thread>
+#include <cassert>
+#include "../common/fast_io.h"
+#include "../common/profiling.h"
+
+// buffer - временный массив размером не меньше end - start, выделяется один раз вызывающим кодом
+template<typename T, typename CompareT>
+void merge(T *arr, int start, int mid, int end, CompareT compare, T *buffer) {
+  if (start == end) {
+    return;
+  }
+  PROFILE_REGION("top_k.merge");
+  int i = start;
+  int j = mid;
+  int k = 0;
+  T *result = buffer;
+
+  while ((i < mid) and (j < end)) {
+    if (compare(arr[i], arr[j])) {
+      result[k] = arr[i];
+      ++i;
+    } else {
+      result[k] = arr[j];
+      ++j;
+    }
+    ++k;
+  }
+
+  while (i < mid) {
+    result[k] = arr[i];
+    ++i;
+    ++k;
+  }
+
+  while (j < end) {
+    result[k] = arr[j];
+    ++j;
+    ++k;
+  }
+
+  for (int m = start; m < end; ++m) {
+    arr[m] = result[m - start];
+  }
+}
+
+// Сливает соседние отсортированные куски [start, mid) и [mid, end) из src в dst на тех же местах,
+// при равенстве первым идёт элемент левого куска
+template<typename T, typename CompareT>
+void merge_runs(const T *src, int start, int mid, int end, T *dst, CompareT compare) {
+  int i = start;
+  int j = mid;
+  int k = start;
+  while (i < mid and j < end) {
+    T left = src[i];
+    T right = src[j];
+    if (compare(right, left)) {
+      dst[k++] = right;
+      ++j;
+    } else {
+      dst[k++] = left;
+      ++i;
+    }
+  }
+  while (i < mid) dst[k++] = src[i++];
+  while (j < end) dst[k++] = src[j++];
+}
+
+// Массивы не длиннее этого сортируются сетью целиком, а более короткие прогоны дополняются сетью до этой длины
+const int SortingNetworkSize = 16;
+
+template<typename T, typename CompareT>
+void compare_exchange(T &left, T &right, CompareT compare) {
+  T first = left;
+  T second = right;
+  bool swap = compare(second, first);
+  left = swap ? second : first;
+  right = swap ? first : second;
+}
+
+// Один слой сети: независимые пары (first, first + 1), (first + 2, first + 3), ...
+// Слой без пар (нечётный слой при N = 2) не использует параметры, проверка убирает предупреждение о них
+template<typename T, typename CompareT, size_t... Pairs>
+void network_layer(T *values, int first, CompareT compare, std::index_sequence<Pairs...>) {
+  if constexpr (sizeof...(Pairs) > 0) {
+    (compare_exchange(values[first + 2 * Pairs], values[first + 2 * Pairs + 1], compare), ...);
+  }
+}
+
+// Сортирующая сеть чётно-нечётных перестановок на N элементов: N слоёв, в каждом сравниваются соседние пары
+// с чередующимся началом. Размер известен при компиляции, поэтому слои разворачиваются, значения живут
+// в регистрах, а обмены идут без ветвлений. Соседние элементы меняются только при строгом неравенстве,
+// так что сеть, в отличие от оптимальных по числу сравнений, устойчива
+template<int N, typename T, typename CompareT>
+void network_sort(T *arr, CompareT compare) {
+  T values[N];
+  std::copy(arr, arr + N, values);
+  for (int layer = 0; layer < N; layer += 2) {
+    network_layer(values, 0, compare, std::make_index_sequence<N / 2>());
+    network_layer(values, 1, compare, std::make_index_sequence<(N - 1) / 2>());
+  }
+  std::copy(values, values + N, arr);
+}
+
+// Выбирает сеть по размеру n <= N
+template<int N, typename T, typename CompareT>
+void small_sort(T *arr, int n, CompareT compare) {
+  if constexpr (N > 1) {
+    if (n == N) {
+      network_sort<N>(arr, compare);
+    } else {
+      small_sort<N - 1>(arr, n, compare);
+    }
+  }
+}
+
+// Размер массива границ прогонов для merge_sort на n элементах: все прогоны, кроме последнего,
+// не короче SortingNetworkSize, плюс граница в конце
+inline int merge_sort_bounds_size(int n) {
+  return n / SortingNetworkSize + 2;
+}
+
+// Сортирует arr[k, n) устойчиво. buffer - временный массив размером не меньше n - k,
+// bounds - не меньше merge_sort_bounds_size(n - k), оба выделяются один раз вызывающим кодом.
+// Сначала массив делится на естественные прогоны (убывающие разворачиваются, короткие дополняются
+// и сортируются сетью до SortingNetworkSize), затем соседние прогоны сливаются попарно, а массив и buffer
+// на каждом проходе меняются ролями, так что данные копируются один раз за проход
+template<typename T, typename CompareT>
+void merge_sort(T *arr, int n, int k, CompareT compare, T *buffer, int *bounds) {
+  arr += k;
+  n -= k;
+  if (n < 2) return;
+  if (n <= SortingNetworkSize) {
+    small_sort<SortingNetworkSize>(arr, n, compare);
+    return;
+  }
+  // bounds[i] - начало i-го прогона, последним лежит n
+  int size = 0;
+  for (int start = 0; start < n;) {
+    int end = start + 1;
+    if (end < n and compare(arr[end], arr[start])) {
+      // строго убывающий прогон, разворот не нарушает устойчивость
+      while (end < n and compare(arr[end], arr[end - 1])) ++end;
+      std::reverse(arr + start, arr + end);
+    } else {
+      while (end < n and !compare(arr[end], arr[end - 1])) ++end;
+    }
+    if (end - start < SortingNetworkSize) {
+      int extended = std::min(n, start + SortingNetworkSize);
+      small_sort<SortingNetworkSize>(arr + start, extended - start, compare);
+      end = extended;
+    }
+    bounds[size++] = start;
+    start = end;
+  }
+  bounds[size++] = n;
+
+  T *src = arr;
+  T *dst = buffer;
+  while (size > 2) {
+    int runs = size - 1;
+    int merged = 0;
+    for (int i = 0; i + 1 < runs; i += 2) {
+      merge_runs(src, bounds[i], bounds[i + 1], bounds[i + 2], dst, compare);
+      bounds[merged++] = bounds[i];
+    }
+    if (runs % 2 == 1) {
+      // непарный последний прогон просто переезжает в другой массив
+      std::copy(src + bounds[runs - 1], src + n, dst + bounds[runs - 1]);
+      bounds[merged++] = bounds[runs - 1];
+    }
+    bounds[merged++] = n;
+    size = merged;
+    std::swap(src, dst);
+  }
+  if (src != arr) std::copy(src, src + n, arr);
+}
+
+template<typename T>
+void print_array(T *arr, int n, OutputWriter *writer) {
+  for (int i = 0; i < n; ++i) {
+    writer->write_int(arr[i]);
+    writer->write_char(' ');
+  }
+}
+
+// Исходный алгоритм: первые k элементов отсортированы, следующие k копятся во второй половине буфера,
+// затем сортируются и сливаются с первой половиной
+template<typename T, typename CompareT>
+class MergeTopK {
+ public:
+  MergeTopK(int k, CompareT compare);
+  ~MergeTopK();
+  MergeTopK(const MergeTopK &) = delete;
+  MergeTopK(MergeTopK &&) = delete;
+  MergeTopK &operator=(const MergeTopK &) = delete;
+  MergeTopK &operator=(MergeTopK &&) = delete;
+  void add(T value);
+  // добавляет сразу блок значений, отбрасывая куски, в которых нет элементов меньше порога
+  void add_block(const T *values, int count);
+  // наименьшие k элементов (или все, если их меньше) в отсортированном порядке
+  std::vector<T> result();
+ private:
+  // по столько элементов блока сравниваются с порогом без ветвлений
+  static const int filter_chunk = 16;
+  int k;
+  T *buffer;
+  T *scratch;
+  // границы прогонов для merge_sort, чтобы сортировка в add не выделяла память
+  int *bounds;
+  int filled = 0;
+  bool head_sorted = false;
+  CompareT compare;
+};
+
+template<typename T, typename CompareT>
+MergeTopK<T, CompareT>::MergeTopK(int k, CompareT compare) {
+  assert(k > 0);
+  this->k = k;
+  this->compare = compare;
+  buffer = new T[2 * k];
+  scratch = new T[2 * k];
+  bounds = new int[merge_sort_bounds_size(2 * k)];
+}
+
+template<typename T, typename CompareT>
+MergeTopK<T, CompareT>::~MergeTopK() {
+  delete[] buffer;
+  delete[] scratch;
+  delete[] bounds;
+}
+
+template<typename T, typename CompareT>
+void MergeTopK<T, CompareT>::add(T value) {
+  // после сортировки первой половины buffer[k - 1] - текущая k-я статистика,
+  // элементы не меньше неё в ответ уже не попадут
+  if (head_sorted and !compare(value, buffer[k - 1])) return;
+  buffer[filled++] = value;
+  if (filled == k and !head_sorted) {
+    merge_sort(buffer, k, 0, compare, scratch, bounds);
+    head_sorted = true;
+  } else if (filled == 2 * k) {
+    // как только заполнится, сортируем вторую половину и мержим с первой
+    merge_sort(buffer, 2 * k, k, compare, scratch, bounds);
+    merge(buffer, 0, k, 2 * k, compare, scratch);
+    filled = k;
+  }
+}
+
+template<typename T, typename CompareT>
+void MergeTopK<T, CompareT>::add_block(const T *values, int count) {
+  int i = 0;
+  while (i < count and !head_sorted) {
+    add(values[i++]);
+  }
+  for (; i + filter_chunk <= count; i += filter_chunk) {
+    // порог уменьшается после каждого слияния
+    T threshold = buffer[k - 1];
+    // цикл без ветвлений компилятор векторизует, на случайных данных почти все куски отбрасываются здесь
+    bool any_less = false;
+    for (int j = 0; j < filter_chunk; ++j) {
+      T value = values[i + j];
+      any_less |= compare(value, threshold);
+    }
+    if (any_less) {
+      for (int j = 0; j < filter_chunk; ++j) {
+        add(values[i + j]);
+      }
+    }
+  }
+  for (; i < count; ++i) {
+    add(values[i]);
+  }
+}
+
+template<typename T, typename CompareT>
+std::vector<T> MergeTopK<T, CompareT>::result() {
+  if (!head_sorted) {
+    merge_sort(buffer, filled, 0, compare, scratch, bounds);
+  } else if (filled > k) {
+    merge_sort(buffer, filled, k, compare, scratch, bounds);
+    merge(buffer, 0, k, filled, compare, scratch);
+  }
+  return std::vector<T>(buffer, buffer + std::min(filled, k));
+}
+
+// Ограниченная куча: на вершине максимум из k лучших, элемент не меньше него сразу отбрасывается
+template<typename T, typename CompareT>
+class HeapTopK {
+ public:
+  HeapTopK(int k, CompareT compare);
+  void add(T value);
+  std::vector<T> result();
+ private:
+  size_t k;
+  std::vector<T> heap;
+  CompareT compare;
+};
+
+template<typename T, typename CompareT>
+HeapTopK<T, CompareT>::HeapTopK(int k, CompareT compare) {
+  assert(k > 0);
+  this->k = k;
+  this->compare = compare;
+  heap.reserve(k);
+}
+
+template<typename T, typename CompareT>
+void HeapTopK<T, CompareT>::add(T value) {
+  auto less = [this](T first, T second) { return compare(first, second); };
+  if (heap.size() < k) {
+    heap.push_back(value);
+    std::push_heap(heap.begin(), heap.end(), less);
+  } else if (compare(value, heap.front())) {
+    // заменяем максимум и восстанавливаем кучу
+    std::pop_heap(heap.begin(), heap.end(), less);
+    heap.back() = value;
+    std::push_heap(heap.begin(), heap.end(), less);
+  }
+}
+
+template<typename T, typename CompareT>
+std::vector<T> HeapTopK<T, CompareT>::result() {
+  std::vector<T> sorted = heap;
+  std::sort_heap(sorted.begin(), sorted.end(), [this](T first, T second) { return compare(first, second); });
+  return sorted;
+}
+
+// Буфер на 2k элементов без сортировки: когда он заполняется, quickselect оставляет k наименьших,
+// а k-й из них становится порогом - всё, что не меньше порога, отбрасывается сразу
+template<typename T, typename CompareT>
+class SelectTopK {
+ public:
+  SelectTopK(int k, CompareT compare);
+  void add(T value);
+  std::vector<T> result();
+ private:
+  int k;
+  std::vector<T> buffer;
+  int filled = 0;
+  bool has_threshold = false;
+  T threshold;
+  CompareT compare;
+  void select();
+};
+
+template<typename T, typename CompareT>
+SelectTopK<T, CompareT>::SelectTopK(int k, CompareT compare) {
+  assert(k > 0);
+  this->k = k;
+  this->compare = compare;
+  buffer.resize(2 * k);
+}
+
+template<typename T, typename CompareT>
+void SelectTopK<T, CompareT>::select() {
+  std::nth_element(buffer.begin(), buffer.begin() + k - 1, buffer.begin() + filled,
+                   [this](T first, T second) { return compare(first, second); });
+  threshold = buffer[k - 1];
+  has_threshold = true;
+  filled = k;
+}
+
+template<typename T, typename CompareT>
+void SelectTopK<T, CompareT>::add(T value) {
+  if (has_threshold and !compare(value, threshold)) return;
+  buffer[filled++] = value;
+  if (filled == 2 * k) select();
+}
+
+template<typename T, typename CompareT>
+std::vector<T> SelectTopK<T, CompareT>::result() {
+  if (filled > k) select();
+  std::vector<T> sorted(buffer.begin(), buffer.begin() + filled);
+  std::vector<T> scratch(filled);
+  std::vector<int> bounds(merge_sort_bounds_size(filled));
+  merge_sort(sorted.data(), filled, 0, compare, scratch.data(), bounds.data());
+  return sorted;
+}
+
+// Слияние отсортированных кусков через кучу из их текущих голов, берутся первые k элементов
+template<typename T, typename CompareT>
+std::vector<T> k_way_merge(const std::vector<std::vector<T>> &parts, int k, CompareT compare) {
+  std::vector<size_t> positions(parts.size(), 0);
+  // на вершине кучи кусок с наименьшей головой
+  auto greater_head = [&](size_t first, size_t second) {
+    T first_head = parts[first][positions[first]];
+    T second_head = parts[second][positions[second]];
+    return compare(second_head, first_head);
+  };
+  std::priority_queue<size_t, std::vector<size_t>, decltype(greater_head)> heads(greater_head);
+  for (size_t i = 0; i < parts.size(); ++i) {
+    if (!parts[i].empty()) heads.push(i);
+  }
+  std::vector<T> result;
+  result.reserve(k);
+  while (static_cast<int>(result.size()) < k and !heads.empty()) {
+    size_t part = heads.top();
+    heads.pop();
+    result.push_back(parts[part][positions[part]]);
+    if (++positions[part] < parts[part].size()) heads.push(part);
+  }
+  return result;
+}
+
+// Кусок входного файла, который целиком обрабатывает один поток
+struct FileRange {
+  const MappedFile *file;
+  size_t begin;
+  size_t end;
+};
+
+// Файлы меньше этого размера (в байтах) на куски не делятся
+const size_t MinRangeSize = 1 << 20;
+
+// Делит файл на parts кусков примерно равной длины. В бинарном файле границы выровнены по размеру элемента,
+// в текстовом сдвигаются вперёд до пробельного символа, чтобы не разрезать число
+template<typename T>
+void split_file(const MappedFile &file, bool binary, int parts, std::vector<FileRange> *ranges) {
+  size_t size = file.size();
+  if (binary) size -= size % sizeof(T);
+  parts = static_cast<int>(std::min<size_t>(parts, size / MinRangeSize + 1));
+  size_t begin = 0;
+  for (int i = 1; i <= parts; ++i) {
+    size_t end = size / parts * i;
+    if (i == parts) {
+      end = size;
+    } else if (binary) {
+      end -= end % sizeof(T);
+    } else {
+      while (end < size and static_cast<unsigned char>(file.data()[end]) > ' ') ++end;
+    }
+    if (end > begin) ranges->push_back({&file, begin, end});
+    begin = std::max(begin, end);
+  }
+}
+
+// false, если в текстовом куске встретилась лексема, которая не является числом
+template<typename T, typename CompareT>
+bool top_k_of_range(const FileRange &range, bool binary, int k, CompareT compare, std::vector<T> *result) {
+  MergeTopK<T, CompareT> top_k(k, compare);
+  const int block_size = 4096;
+  if (binary) {
+    // значения берутся прямо из отображённого файла, без копирования
+    const T *values = reinterpret_cast<const T *>(range.file->data() + range.begin);
+    size_t count = (range.end - range.begin) / sizeof(T);
+    for (size_t done = 0; done < count; done += block_size) {
+      top_k.add_block(values + done, static_cast<int>(std::min<size_t>(block_size, count - done)));
+    }
+  } else {
+    InputReader reader(range.file->data() + range.begin, range.end - range.begin);
+    T block[block_size];
+    int count = block_size;
+    while (count == block_size) {
+      count = 0;
+      while (count < block_size and reader.read_int(&block[count])) ++count;
+      if (count < block_size and !reader.at_end()) return false;
+      top_k.add_block(block, count);
+    }
+  }
+  *result = top_k.result();
+  return true;
+}
+
+// Режим для данных, которые читаются из файлов: каждый файл делится на куски, потоки разбирают куски
+// из общей очереди и считают по ним локальные top-k, которые затем сливаются в ответ.
+// Возвращает false, если в текстовом файле есть лексема, которая не является числом
+template<typename T, typename CompareT>
+bool top_k_from_files(const std::deque<MappedFile> &files, bool binary, int k, CompareT compare, int threads,
+                      std::vector<T> *result) {
+  std::vector<FileRange> ranges;
+  for (const MappedFile &file : files) {
+    split_file<T>(file, binary, threads, &ranges);
+  }
+  std::vector<std::vector<T>> partial(ranges.size());
+  std::atomic<size_t> next_range(0);
+  std::atomic<bool> valid(true);
+  auto worker = [&]() {
+    for (size_t i = next_range++; i < ranges.size() and valid; i = next_range++) {
+      if (!top_k_of_range<T>(ranges[i], binary, k, compare, &partial[i])) valid = false;
+    }
+  };
+  std::vector<std::thread> workers;
+  for (int i = 1; i < std::min<int>(threads, static_cast<int>(ranges.size())); ++i) {
+    workers.emplace_back(worker);
+  }
+  worker();
+  for (std::thread &thread : workers) {
+    thread.join();
+  }
+  if (!valid) return false;
+  *result = k_way_merge(partial, k, compare);
+  return true;
+}
+
+template<typename T>
+class ComparerLess {
+ public:
+  bool operator()(T &first, T &second) const;
+};
+template<typename T>
+bool ComparerLess<T>::operator()(T &first, T &second) const {
+  return first < second;
+}
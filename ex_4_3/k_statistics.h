@@ -0,0 +1,482 @@
+// Поиск k-й порядковой статистики: нерекурсивный introselect (вложенный выбор медианы медиан идёт
+// через явный стек), выбор нескольких статистик за раз, параллельный выбор и KLL-скетч для потока
+#pragma once
+
+#include <utility>
+#include <algorithm>
+#include <vector>
+#include <random>
+#include <thread>
+#include <functional>
+#include <cmath>
+#include <cassert>
+#include <cstdint>
+#include "../common/fast_io.h"
+#include "../common/profiling.h"
+
+// куски не больше этого досортировываем вставками
+const int InsertionSortSize = 16;
+// начиная с этого размера опорный элемент - медиана девяти
+const int NintherSize = 128;
+
+// переносит в начало отрезка элементы, для которых predicate истинен, возвращает конец этой части.
+// Оба итератора идут в одном направлении, обмен выполняется всегда, а i сдвигается на результат
+// сравнения, поэтому в цикле нет ветвления, зависящего от данных
+template<typename T, typename PredicateT>
+int64_t partition(T *arr, int64_t start, int64_t stop, PredicateT predicate) {
+  PROFILE_REGION("select.partition");
+  int64_t i = start;
+  for (int64_t j = start; j < stop; ++j) {
+    T value = arr[j];
+    bool moved = predicate(value);
+    arr[j] = arr[i];
+    arr[i] = value;
+    i += moved;
+  }
+  return i;
+}
+
+template<typename T, typename CompareT>
+void insertion_sort(T *arr, int64_t start, int64_t stop, CompareT compare) {
+  for (int64_t i = start + 1; i < stop; ++i) {
+    T value = arr[i];
+    int64_t j = i;
+    while (j > start and compare(value, arr[j - 1])) {
+      arr[j] = arr[j - 1];
+      --j;
+    }
+    arr[j] = value;
+  }
+}
+
+template<typename T, typename CompareT>
+T median_of_three(T a, T b, T c, CompareT compare) {
+  if (compare(b, a)) std::swap(a, b);
+  if (compare(c, b)) std::swap(b, c);
+  if (compare(b, a)) std::swap(a, b);
+  return b;
+}
+
+// медиана трёх или, на больших отрезках, медиана трёх медиан по девяти равномерно взятым элементам
+template<typename T, typename CompareT>
+T sample_pivot(T *arr, int64_t start, int64_t stop, CompareT compare) {
+  int64_t size = stop - start;
+  int64_t mid = start + size / 2;
+  if (size < NintherSize) {
+    return median_of_three(arr[start], arr[mid], arr[stop - 1], compare);
+  }
+  int64_t step = size / 8;
+  return median_of_three(median_of_three(arr[start], arr[start + step], arr[start + 2 * step], compare),
+                         median_of_three(arr[mid - step], arr[mid], arr[mid + step], compare),
+                         median_of_three(arr[stop - 1 - 2 * step], arr[stop - 1 - step], arr[stop - 1], compare),
+                         compare);
+}
+
+// сколько плохих разбиений (больше 3/4 отрезка осталось) допускаем до перехода на медиану медиан.
+// Запас не растёт с n: каждое плохое разбиение - лишний проход по почти всему отрезку, и при запасе
+// порядка log n подобранный вход заставлял сделать столько проходов до медианы медиан
+const int BadSplitsAllowed = 2;
+
+// Собирает медианы пятёрок отрезка в его начало, возвращает их количество
+template<typename T, typename CompareT>
+int64_t gather_group_medians(T *arr, int64_t start, int64_t stop, CompareT compare) {
+  int64_t groups = 0;
+  for (int64_t group_start = start; group_start < stop; group_start += 5) {
+    int64_t group_stop = std::min(group_start + 5, stop);
+    insertion_sort(arr, group_start, group_stop, compare);
+    std::swap(arr[start + groups], arr[group_start + (group_stop - group_start) / 2]);
+    ++groups;
+  }
+  return groups;
+}
+
+// Каждый уровень медианы медиан выбирает на пятой части отрезка, так что для отрезков до 2^63 хватает 28 уровней
+const int MaxSelectionDepth = 28;
+
+// Introselect: опорный элемент по выборке, а если отрезок слишком часто уменьшается плохо -
+// медиана медиан пятёрок, которая гарантирует уменьшение отрезка хотя бы на 3/10 и линейное время
+// в худшем случае. Медиана медиан сама ищется выбором на начале отрезка, куда собраны медианы пятёрок;
+// вместо рекурсии этот вложенный выбор кладётся в стек, а его ответ становится опорным элементом
+// для отложенного отрезка.
+// Разбиение на три части (меньше, равные, больше) не деградирует на повторяющихся значениях
+template<typename T, typename CompareT>
+T get_k_order_statistic(int64_t n, int64_t k, T *arr, CompareT cmp) {
+  struct Selection {
+    int64_t start;
+    int64_t end;
+    int64_t k;
+    int bad_splits_left;
+  };
+  Selection stack[MaxSelectionDepth];
+  int depth = 0;
+  stack[0] = Selection{0, n, k, BadSplitsAllowed};
+  T pivot;
+  // pivot получен от вложенного выбора и ещё не использован
+  bool has_pivot = false;
+  while (true) {
+    Selection &current = stack[depth];
+    int64_t size = current.end - current.start;
+    if (!has_pivot) {
+      if (size <= InsertionSortSize) {
+        insertion_sort(arr, current.start, current.end, cmp);
+        if (depth == 0) return arr[current.k];
+        pivot = arr[current.k];
+        has_pivot = true;
+        --depth;
+        continue;
+      }
+      if (current.bad_splits_left > 0) {
+        pivot = sample_pivot(arr, current.start, current.end, cmp);
+      } else {
+        int64_t groups = gather_group_medians(arr, current.start, current.end, cmp);
+        assert(depth + 1 < MaxSelectionDepth);
+        int64_t groups_end = current.start + groups;
+        stack[depth + 1] = Selection{current.start, groups_end, current.start + groups / 2, BadSplitsAllowed};
+        ++depth;
+        continue;
+      }
+    }
+    has_pivot = false;
+    // сначала переносим в начало меньшие опорного, затем среди оставшихся - равные ему
+    int64_t less_end = partition(arr, current.start, current.end,
+                                 [&pivot, &cmp](T &value) { return cmp(value, pivot); });
+    int64_t equal_end = partition(arr, less_end, current.end, [&pivot, &cmp](T &value) { return !cmp(pivot, value); });
+    if (current.k < less_end) {
+      current.end = less_end;
+    } else if (current.k >= equal_end) {
+      current.start = equal_end;
+    } else {
+      // ответ - сам опорный элемент, для вложенного выбора он же опорный элемент отложенного отрезка
+      if (depth == 0) return pivot;
+      has_pivot = true;
+      --depth;
+      continue;
+    }
+    if (4 * (current.end - current.start) > 3 * size) --current.bad_splits_left;
+  }
+}
+
+// медиана медиан пятёрок отрезка, без рекурсии: медианы собираются в начале отрезка,
+// их медиана ищется get_k_order_statistic
+template<typename T, typename CompareT>
+T median_of_medians(T *arr, int64_t start, int64_t stop, CompareT compare) {
+  int64_t groups = gather_group_medians(arr, start, stop, compare);
+  return get_k_order_statistic(groups, groups / 2, arr + start, compare);
+}
+
+// Несколько порядковых статистик за одно разбиение: отрезки, в которые не попал ни один
+// из запрошенных k, дальше не обрабатываются. ks должны быть отсортированы
+template<typename T, typename CompareT>
+std::vector<T> select_many(int64_t n, const std::vector<int64_t> &ks, T *arr, CompareT cmp) {
+  assert(std::is_sorted(ks.begin(), ks.end()));
+  std::vector<T> result(ks.size());
+  struct Range {
+    int64_t start;
+    int64_t end;
+    // номера запросов, попадающих в отрезок
+    int ks_start;
+    int ks_end;
+    int bad_splits_left;
+  };
+  std::vector<Range> ranges;
+  if (!ks.empty()) ranges.push_back(Range{0, n, 0, static_cast<int>(ks.size()), BadSplitsAllowed});
+  while (!ranges.empty()) {
+    Range range = ranges.back();
+    ranges.pop_back();
+    int64_t size = range.end - range.start;
+    if (size <= InsertionSortSize) {
+      insertion_sort(arr, range.start, range.end, cmp);
+      for (int i = range.ks_start; i < range.ks_end; ++i) {
+        result[i] = arr[ks[i]];
+      }
+      continue;
+    }
+
+    T pivot = range.bad_splits_left > 0 ? sample_pivot(arr, range.start, range.end, cmp)
+                                        : median_of_medians(arr, range.start, range.end, cmp);
+    int64_t less_end = partition(arr, range.start, range.end, [&pivot, &cmp](T &value) { return cmp(value, pivot); });
+    int64_t equal_end = partition(arr, less_end, range.end, [&pivot, &cmp](T &value) { return !cmp(pivot, value); });
+    // делим запросы: левее равных опорному, среди них и правее
+    auto ks_begin = ks.begin();
+    int left_ks_end = std::lower_bound(ks_begin + range.ks_start, ks_begin + range.ks_end, less_end) - ks_begin;
+    int right_ks_start = std::lower_bound(ks_begin + left_ks_end, ks_begin + range.ks_end, equal_end) - ks_begin;
+    for (int i = left_ks_end; i < right_ks_start; ++i) {
+      result[i] = pivot;
+    }
+    if (range.ks_start < left_ks_end) {
+      int bad = 4 * (less_end - range.start) > 3 * size;
+      ranges.push_back(Range{range.start, less_end, range.ks_start, left_ks_end, range.bad_splits_left - bad});
+    }
+    if (right_ks_start < range.ks_end) {
+      int bad = 4 * (range.end - equal_end) > 3 * size;
+      ranges.push_back(Range{equal_end, range.end, right_ks_start, range.ks_end, range.bad_splits_left - bad});
+    }
+  }
+  return result;
+}
+
+// меньше этого размера параллельный выбор не окупается
+const int ParallelSelectSize = 1 << 20;
+// размер случайной выборки для выбора границ отрезка-кандидата
+const int SelectSampleSize = 1 << 14;
+
+// Параллельный выбор без изменения arr. По выборке берём две границы, между которыми k-я статистика
+// почти наверняка лежит. Потоки считают в своих кусках элементы меньше нижней границы и между границами,
+// затем копируют элементы между границами в общий буфер, в котором k-я статистика ищется последовательно.
+template<typename T, typename CompareT>
+T parallel_k_order_statistic(int n, int k, const T *arr, CompareT cmp, int threads) {
+  if (threads < 2 or n < ParallelSelectSize) {
+    std::vector<T> copy(arr, arr + n);
+    return get_k_order_statistic(n, k, copy.data(), cmp);
+  }
+
+  std::minstd_rand random(n);
+  std::vector<T> sample(SelectSampleSize);
+  for (T &value : sample) {
+    value = arr[random() % n];
+  }
+  std::sort(sample.begin(), sample.end(), [&cmp](T first, T second) { return cmp(first, second); });
+  // ранг k в выборке отклоняется от ожидаемого на величину порядка sqrt(выборки) / 2, берём запас в 4 раза больше
+  long long expected = static_cast<long long>(k) * SelectSampleSize / n;
+  int delta = 2 * static_cast<int>(std::sqrt(static_cast<double>(SelectSampleSize)));
+  T low = sample[std::max(0LL, expected - delta)];
+  T high = sample[std::min(static_cast<long long>(SelectSampleSize) - 1, expected + delta)];
+
+  std::vector<int> less_counts(threads);
+  std::vector<int> middle_counts(threads);
+  auto chunk_start = [n, threads](int chunk) {
+    return static_cast<int>(static_cast<long long>(n) * chunk / threads);
+  };
+  auto run_chunks = [threads](const std::function<void(int)> &action) {
+    std::vector<std::thread> workers;
+    for (int chunk = 1; chunk < threads; ++chunk) {
+      workers.emplace_back(action, chunk);
+    }
+    action(0);
+    for (auto &worker : workers) worker.join();
+  };
+
+  run_chunks([&](int chunk) {
+    int less = 0;
+    int middle = 0;
+    for (int i = chunk_start(chunk); i < chunk_start(chunk + 1); ++i) {
+      T value = arr[i];
+      bool is_less = cmp(value, low);
+      bool is_greater = cmp(high, value);
+      less += is_less;
+      middle += !is_less and !is_greater;
+    }
+    less_counts[chunk] = less;
+    middle_counts[chunk] = middle;
+  });
+
+  int less_total = 0;
+  int middle_total = 0;
+  std::vector<int> offsets(threads);
+  for (int chunk = 0; chunk < threads; ++chunk) {
+    less_total += less_counts[chunk];
+    offsets[chunk] = middle_total;
+    middle_total += middle_counts[chunk];
+  }
+  if (k < less_total or k >= less_total + middle_total) {
+    // выборка обманула, что бывает крайне редко
+    std::vector<T> copy(arr, arr + n);
+    return get_k_order_statistic(n, k, copy.data(), cmp);
+  }
+
+  std::vector<T> candidates(middle_total);
+  run_chunks([&](int chunk) {
+    int position = offsets[chunk];
+    for (int i = chunk_start(chunk); i < chunk_start(chunk + 1); ++i) {
+      T value = arr[i];
+      if (!cmp(value, low) and !cmp(high, value)) {
+        candidates[position++] = value;
+      }
+    }
+  });
+  return get_k_order_statistic(middle_total, k - less_total, candidates.data(), cmp);
+}
+
+// Потоковая приближённая порядковая статистика: KLL-скетч (Karnin, Lang, Liberty).
+// Уровень h хранит элементы с весом 2^h. Когда уровень переполняется, он сортируется,
+// и каждый второй элемент (со случайным сдвигом) переходит на уровень выше.
+// Ёмкость уровней убывает геометрически вниз от верхнего, поэтому память O(k),
+// а ошибка ранга не больше rank_error() * count() с вероятностью около 99%.
+template<typename T, typename CompareT>
+class KllSketch {
+ public:
+  KllSketch(int k, CompareT compare);
+  KllSketch(const KllSketch &) = delete;
+  KllSketch(KllSketch &&) = delete;
+  KllSketch &operator=(const KllSketch &) = delete;
+  KllSketch &operator=(KllSketch &&) = delete;
+  void update(T value);
+  // приближённая k-я статистика среди всех добавленных элементов
+  T get_k_stat(long long k) const;
+  long long count() const;
+  // сколько элементов хранится в скетче
+  size_t retained() const;
+  // относительная ошибка ранга, приближение из DataSketches для KLL
+  double rank_error() const;
+ private:
+  const double capacity_ratio = 2.0 / 3.0;
+  int k;
+  long long items_count = 0;
+  size_t retained_count = 0;
+  size_t max_retained = 0;
+  std::vector<std::vector<T>> levels;
+  std::minstd_rand random;
+  CompareT compare;
+  size_t capacity(size_t level) const;
+  void grow();
+  void compress();
+};
+
+template<typename T, typename CompareT>
+KllSketch<T, CompareT>::KllSketch(int k, CompareT compare) : random(k) {
+  this->k = k;
+  this->compare = compare;
+  grow();
+}
+
+template<typename T, typename CompareT>
+size_t KllSketch<T, CompareT>::capacity(size_t level) const {
+  size_t depth = levels.size() - level - 1;
+  return static_cast<size_t>(std::ceil(std::pow(capacity_ratio, depth) * k)) + 1;
+}
+
+template<typename T, typename CompareT>
+void KllSketch<T, CompareT>::grow() {
+  levels.emplace_back();
+  max_retained = 0;
+  for (size_t level = 0; level < levels.size(); ++level) {
+    max_retained += capacity(level);
+  }
+}
+
+template<typename T, typename CompareT>
+void KllSketch<T, CompareT>::update(T value) {
+  levels[0].push_back(value);
+  ++items_count;
+  ++retained_count;
+  if (retained_count >= max_retained) compress();
+}
+
+template<typename T, typename CompareT>
+void KllSketch<T, CompareT>::compress() {
+  for (size_t level = 0; level < levels.size(); ++level) {
+    if (levels[level].size() < capacity(level)) continue;
+    if (level + 1 == levels.size()) grow();
+    auto &current = levels[level];
+    std::sort(current.begin(), current.end(), [this](T first, T second) { return compare(first, second); });
+    // при нечётном размере последний элемент остаётся на уровне
+    bool keep_last = current.size() % 2 == 1;
+    T last = current.back();
+    if (keep_last) current.pop_back();
+    size_t offset = random() % 2;
+    for (size_t i = offset; i < current.size(); i += 2) {
+      levels[level + 1].push_back(current[i]);
+    }
+    retained_count -= current.size() / 2;
+    current.clear();
+    if (keep_last) current.push_back(last);
+    if (retained_count < max_retained) break;
+  }
+}
+
+template<typename T, typename CompareT>
+T KllSketch<T, CompareT>::get_k_stat(long long k) const {
+  assert(k >= 0 and k < items_count);
+  std::vector<std::pair<T, long long>> weighted;
+  weighted.reserve(retained_count);
+  for (size_t level = 0; level < levels.size(); ++level) {
+    for (const T &value : levels[level]) {
+      weighted.emplace_back(value, 1LL << level);
+    }
+  }
+  auto by_value = [this](std::pair<T, long long> first, std::pair<T, long long> second) {
+    return compare(first.first, second.first);
+  };
+  std::sort(weighted.begin(), weighted.end(), by_value);
+  long long rank = 0;
+  for (const auto &item : weighted) {
+    rank += item.second;
+    if (rank > k) return item.first;
+  }
+  return weighted.back().first;
+}
+
+template<typename T, typename CompareT>
+long long KllSketch<T, CompareT>::count() const {
+  return items_count;
+}
+
+template<typename T, typename CompareT>
+size_t KllSketch<T, CompareT>::retained() const {
+  return retained_count;
+}
+
+template<typename T, typename CompareT>
+double KllSketch<T, CompareT>::rank_error() const {
+  return 2.296 / std::pow(static_cast<double>(k), 0.9723);
+}
+
+// Второй проход для точного ответа: считаем элементы меньше low и сохраняем только элементы из [low, high]
+template<typename T, typename CompareT>
+class RangeSelector {
+ public:
+  RangeSelector(T low, T high, CompareT compare);
+  void update(T value);
+  // false, если k-я статистика не попала в [low, high] и нужен ещё один проход с более широким отрезком
+  bool get_k_stat(long long k, T *result);
+ private:
+  T low;
+  T high;
+  long long less_count = 0;
+  std::vector<T> candidates;
+  CompareT compare;
+};
+
+template<typename T, typename CompareT>
+RangeSelector<T, CompareT>::RangeSelector(T low, T high, CompareT compare) {
+  this->low = low;
+  this->high = high;
+  this->compare = compare;
+}
+
+template<typename T, typename CompareT>
+void RangeSelector<T, CompareT>::update(T value) {
+  if (compare(value, low)) {
+    ++less_count;
+  } else if (!compare(high, value)) {
+    candidates.push_back(value);
+  }
+}
+
+template<typename T, typename CompareT>
+bool RangeSelector<T, CompareT>::get_k_stat(long long k, T *result) {
+  if (k < less_count or k >= less_count + static_cast<long long>(candidates.size())) return false;
+  *result = get_k_order_statistic(static_cast<int64_t>(candidates.size()), k - less_count, candidates.data(), compare);
+  return true;
+}
+
+// отрезок для второго прохода: статистики скетча с запасом в margin_scale ошибок ранга в обе стороны
+template<typename T, typename CompareT>
+RangeSelector<T, CompareT> narrow_range(const KllSketch<T, CompareT> &sketch, long long k, CompareT compare,
+                                        double margin_scale = 1) {
+  long long margin = static_cast<long long>(std::ceil(margin_scale * sketch.rank_error() * sketch.count()));
+  T low = sketch.get_k_stat(std::max(0LL, k - margin));
+  T high = sketch.get_k_stat(std::min(sketch.count() - 1, k + margin));
+  return RangeSelector<T, CompareT>(low, high, compare);
+}
+
+// Компаратор
+template<typename T>
+class ComparerLess {
+ public:
+  bool operator()(T &first, T &second) const;
+};
+template<typename T>
+bool ComparerLess<T>::operator()(T &first, T &second) const {
+  return first < second;
+}
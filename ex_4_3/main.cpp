@@ -6,73 +6,103 @@
  Требуемое среднее время работы: O(n).
  Функцию Partition следует реализовывать методом прохода двумя итераторами в одном направлении.
  */
-#include <iostream>
+#include <thread>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include "k_statistics.h"
+#include "../common/fast_io.h"
 
-// функция возвращает место опорного элмента в измененном массиве
-template<typename T, typename CompareT>
-int partition(T *arr, int start, int stop, int pivot_index, CompareT compare) {
-  std::swap(arr[stop - 1], arr[pivot_index]);
-  // i указывает на первый элемент больше опорного
-  // j следующий не проверенный элемент
-  int i = start;
-  while (compare(arr[i], arr[stop - 1])) {
-    ++i;
-  }
-  int j = i + 1;
-  while (j < stop - 1) {
-    if (compare(arr[stop - 1], arr[j])) {
-      ++j;
-    } else {
-      std::swap(arr[i], arr[j]);
-      ++i;
-      ++j;
-    }
+// размер KLL-скетча в потоковом режиме: ошибка ранга около 1.3%, во втором проходе остаётся пара процентов входа
+const int StreamSketchSize = 200;
+
+// Передаёт в action n чисел, идущих в файле после n и k.
+// false, если в файле меньше n чисел или среди них есть лексема, которая не является числом
+template<typename ActionT>
+bool for_each_stream_value(const MappedFile &file, long long n, ActionT action) {
+  InputReader reader(file.data(), file.size());
+  long long header = 0;
+  reader.read_int(&header);
+  reader.read_int(&header);
+  int value = 0;
+  for (long long i = 0; i < n; ++i) {
+    if (!reader.read_int(&value)) return false;
+    action(value);
   }
-  std::swap(arr[i], arr[stop - 1]);
-  return i;
+  return true;
 }
 
-template<typename T, typename CompareT>
-T get_k_order_statistic(int n, int k, T *arr, CompareT cmp) {
-  int start = 0;
-  int end = n;
-  int pivot_place = -1;
-  T pivot_element;
-  while (pivot_place != k) {
-    // рандомно выбираем опорный элемент
-    int pivot = start + (rand() % (end - start));
-    pivot_element = arr[pivot];
-    pivot_place = partition(arr, start, end, pivot, cmp);
-    if (k < pivot_place) {
-      end = pivot_place;
-    } else if (k > pivot_place) {
-      start = pivot_place + 1;
+// Потоковый режим: вход в том же формате читается из файла в два прохода, массив целиком в память не попадает.
+// Первый проход строит KLL-скетч, второй сохраняет только элементы между его оценками статистик k -+ ошибка ранга.
+// Если k-я статистика не попала в отрезок, второй проход повторяется с удвоенным запасом
+int stream_k_order_statistic(const char *path, OutputWriter &writer) {
+  MappedFile file(path);
+  if (!file.is_open()) {
+    fprintf(stderr, "cannot open %s\n", path);
+    return 1;
+  }
+  InputReader header(file.data(), file.size());
+  long long n = 0;
+  long long k = 0;
+  if (!header.read_int(&n) or !header.read_int(&k) or k < 0 or k >= n) {
+    fprintf(stderr, "expected n > 0 and k in [0, n) at the start of %s\n", path);
+    return 1;
+  }
+
+  KllSketch<int, ComparerLess<int>> sketch(StreamSketchSize, ComparerLess<int>());
+  if (!for_each_stream_value(file, n, [&sketch](int value) { sketch.update(value); })) {
+    fprintf(stderr, "expected %lld values in %s\n", n, path);
+    return 1;
+  }
+
+  for (double margin_scale = 1;; margin_scale *= 2) {
+    // скетч может не хранить крайних значений, поэтому запас во весь вход заменяется всем диапазоном int
+    auto selector = margin_scale * sketch.rank_error() < 1
+                    ? narrow_range(sketch, k, ComparerLess<int>(), margin_scale)
+                    : RangeSelector<int, ComparerLess<int>>(std::numeric_limits<int>::min(),
+                                                            std::numeric_limits<int>::max(), ComparerLess<int>());
+    // файл тот же, что в первом проходе, так что чтение уже не может оборваться
+    for_each_stream_value(file, n, [&selector](int value) { selector.update(value); });
+    int k_order_statistic;
+    if (selector.get_k_stat(k, &k_order_statistic)) {
+      writer.write_int(k_order_statistic);
+      return 0;
     }
   }
-  return pivot_element;
 }
 
-// Компаратор
-template<typename T>
-class ComparerLess {
- public:
-  bool operator()(T &first, T &second) const;
-};
-template<typename T>
-bool ComparerLess<T>::operator()(T &first, T &second) const {
-  return first < second;
-}
+// Без аргументов массив читается из stdin целиком. Аргументы:
+// --stream input.txt - тот же вход читается из файла в два прохода с памятью O(размер скетча + доля n)
+int main(int argc, char **argv) {
+  OutputWriter writer;
+  if (argc == 3 and std::strcmp(argv[1], "--stream") == 0) {
+    return stream_k_order_statistic(argv[2], writer);
+  }
+  if (argc != 1) {
+    fprintf(stderr, "usage: %s [--stream input.txt]\n", argv[0]);
+    return 1;
+  }
 
-int main() {
-  int n, k;
-  std::cin >> n >> k;
+  InputReader reader;
+  int n = 0;
+  int k = 0;
+  if (!reader.read_int(&n) or !reader.read_int(&k) or k < 0 or k >= n) {
+    fprintf(stderr, "expected n > 0 and k in [0, n)\n");
+    return 1;
+  }
   int *arr = new int[n];
 
   for (int i = 0; i < n; ++i) {
-    std::cin >> arr[i];
+    if (!reader.read_int(&arr[i])) {
+      fprintf(stderr, "expected %d values\n", n);
+      delete[] arr;
+      return 1;
+    }
   }
 
-  int k_order_statistic = get_k_order_statistic(n, k, arr, ComparerLess<int>());
-  std::cout << k_order_statistic;
+  int threads = static_cast<int>(std::thread::hardware_concurrency());
+  int k_order_statistic = threads > 1 ? parallel_k_order_statistic(n, k, arr, ComparerLess<int>(), threads)
+                                      : get_k_order_statistic(n, k, arr, ComparerLess<int>());
+  writer.write_int(k_order_statistic);
   delete[] arr;
 }
@@ -0,0 +1,448 @@
+// Бинарное дерево поиска с наивным порядком вставки, его копия только для чтения в порядке Эйтцингера
+// и параллельное построение pre-order обхода
+#pragma once
+
+#include <vector>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <memory_resource>
+#include "../common/fast_io.h"
+
+// вершины лежат в общем массиве, вместо указателей храним индексы
+template<typename T>
+struct Node {
+  explicit Node(T value) {
+    this->value = value;
+  }
+  T value;
+  int left = -1;
+  int right = -1;
+};
+
+template<typename T, typename CompareT>
+class FrozenTree;
+
+template<typename T, typename CompareT>
+class SimpleTree {
+ public:
+  // массивы вершин и ветвей выделяются из resource, например из MonotonicArena
+  explicit SimpleTree(CompareT compare, std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+  SimpleTree(const SimpleTree &) = delete;
+  SimpleTree(SimpleTree &&) = delete;
+  SimpleTree &operator=(const SimpleTree &) = delete;
+  SimpleTree &operator=(SimpleTree &&) = delete;
+  void reserve(int n);
+  void add(T value);
+  // печатает значения в порядке pre-order через пробел, как main печатает результат parallel_pre_order
+  void print(OutputWriter *writer);
+  // дописывает значения в порядке pre-order в конец result
+  void pre_order_values(std::vector<T> *result);
+  // дописывает значения в порядке in-order, т.е. отсортированными
+  void in_order_values(std::vector<T> *result);
+  bool contains(T value);
+  // копирует ключи в компактное дерево только для чтения
+  void freeze(FrozenTree<T, CompareT> *frozen);
+ private:
+  // все вершины освобождаются вместе с массивом
+  std::pmr::vector<Node<T>> nodes;
+  // правая ветвь от корня (значения не убывают) и левая ветвь (значения убывают),
+  // по ним двоичным поиском находим место, где путь вставки с них сходит
+  std::pmr::vector<int> right_spine;
+  std::pmr::vector<int> left_spine;
+  CompareT compare;
+  int new_node(T value);
+  void descend(int node, T value);
+  // что бы не дублировать код обхода дерева, принимаем на вход функтор,
+  // который будет выполнять необходимую работу
+  template<typename ActionT>
+  void pre_order(ActionT action);
+};
+
+template<typename T, typename CompareT>
+SimpleTree<T, CompareT>::SimpleTree(CompareT compare, std::pmr::memory_resource *resource)
+    : nodes(resource), right_spine(resource), left_spine(resource) {
+  this->compare = compare;
+}
+
+template<typename T, typename CompareT>
+void SimpleTree<T, CompareT>::reserve(int n) {
+  nodes.reserve(n);
+}
+
+template<typename T, typename CompareT>
+int SimpleTree<T, CompareT>::new_node(T value) {
+  nodes.emplace_back(value);
+  return static_cast<int>(nodes.size()) - 1;
+}
+
+// обычная вставка начиная с вершины node
+template<typename T, typename CompareT>
+void SimpleTree<T, CompareT>::descend(int node, T value) {
+  while (true) {
+    if (this->compare(value, nodes[node].value)) {
+      // если значение меньше текущего, уходим влево и проверяем следующую вершину
+      if (nodes[node].left == -1) {
+        int child = new_node(value);
+        nodes[node].left = child;
+        return;
+      }
+      node = nodes[node].left;
+    } else {
+      // иначе уходим вправо
+      if (nodes[node].right == -1) {
+        int child = new_node(value);
+        nodes[node].right = child;
+        return;
+      }
+      node = nodes[node].right;
+    }
+  }
+}
+
+template<typename T, typename CompareT>
+void SimpleTree<T, CompareT>::add(T value) {
+  if (nodes.empty()) {
+    int root = new_node(value);
+    right_spine.push_back(root);
+    left_spine.push_back(root);
+    return;
+  }
+
+  if (!this->compare(value, nodes[0].value)) {
+    // путь идёт по правой ветви, пока значения на ней не больше value
+    if (!this->compare(value, nodes[right_spine.back()].value)) {
+      // новый максимум, на отсортированном входе всегда попадаем сюда
+      int child = new_node(value);
+      nodes[right_spine.back()].right = child;
+      right_spine.push_back(child);
+      return;
+    }
+    int low = 0;
+    int high = static_cast<int>(right_spine.size()) - 1;
+    // ищем первую вершину ветви, которая больше value
+    while (low < high) {
+      int mid = (low + high) / 2;
+      if (this->compare(value, nodes[right_spine[mid]].value)) {
+        high = mid;
+      } else {
+        low = mid + 1;
+      }
+    }
+    int node = right_spine[low];
+    if (nodes[node].left == -1) {
+      int child = new_node(value);
+      nodes[node].left = child;
+    } else {
+      descend(nodes[node].left, value);
+    }
+  } else {
+    // симметрично для левой ветви
+    if (this->compare(value, nodes[left_spine.back()].value)) {
+      int child = new_node(value);
+      nodes[left_spine.back()].left = child;
+      left_spine.push_back(child);
+      return;
+    }
+    int low = 0;
+    int high = static_cast<int>(left_spine.size()) - 1;
+    // ищем первую вершину ветви, которая не больше value
+    while (low < high) {
+      int mid = (low + high) / 2;
+      if (this->compare(value, nodes[left_spine[mid]].value)) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    int node = left_spine[low];
+    if (nodes[node].right == -1) {
+      int child = new_node(value);
+      nodes[node].right = child;
+    } else {
+      descend(nodes[node].right, value);
+    }
+  }
+}
+
+template<typename T, typename CompareT>
+template<typename ActionT>
+void SimpleTree<T, CompareT>::pre_order(ActionT action) {
+  if (nodes.empty()) return;
+  std::vector<int> stack;
+  stack.push_back(0);
+  // идём от корня вниз
+  while (!stack.empty()) {
+    auto &next_element = nodes[stack.back()];
+    stack.pop_back();
+
+    if (next_element.right != -1) {
+      stack.push_back(next_element.right);
+    }
+
+    // первым всегда будет обработан левый элемент
+    if (next_element.left != -1) {
+      stack.push_back(next_element.left);
+    }
+
+    action(next_element);
+  }
+}
+
+template<typename T, typename CompareT>
+void SimpleTree<T, CompareT>::print(OutputWriter *writer) {
+  pre_order([writer](Node<T> &node) {
+    writer->write_int(node.value);
+    writer->write_char(' ');
+  });
+}
+
+template<typename T, typename CompareT>
+void SimpleTree<T, CompareT>::pre_order_values(std::vector<T> *result) {
+  pre_order([result](Node<T> &node) {
+    result->push_back(node.value);
+  });
+}
+
+template<typename T, typename CompareT>
+void SimpleTree<T, CompareT>::in_order_values(std::vector<T> *result) {
+  std::vector<int> stack;
+  int node = nodes.empty() ? -1 : 0;
+  while (node != -1 or !stack.empty()) {
+    // спускаемся влево до упора, потом выводим вершину и переходим в правое поддерево
+    while (node != -1) {
+      stack.push_back(node);
+      node = nodes[node].left;
+    }
+    node = stack.back();
+    stack.pop_back();
+    result->push_back(nodes[node].value);
+    node = nodes[node].right;
+  }
+}
+
+template<typename T, typename CompareT>
+bool SimpleTree<T, CompareT>::contains(T value) {
+  int node = nodes.empty() ? -1 : 0;
+  while (node != -1) {
+    if (this->compare(value, nodes[node].value)) {
+      node = nodes[node].left;
+    } else if (this->compare(nodes[node].value, value)) {
+      node = nodes[node].right;
+    } else {
+      return true;
+    }
+  }
+  return false;
+}
+
+template<typename T, typename CompareT>
+void SimpleTree<T, CompareT>::freeze(FrozenTree<T, CompareT> *frozen) {
+  std::vector<T> sorted;
+  sorted.reserve(nodes.size());
+  in_order_values(&sorted);
+  frozen->build(sorted);
+}
+
+// Дерево поиска только для чтения в порядке Эйтцингера (обход в ширину идеально сбалансированного дерева):
+// потомки вершины k лежат в 2k и 2k + 1, поэтому верхние уровни всегда в кэше,
+// а спуск не зависит от формы исходного дерева
+template<typename T, typename CompareT>
+class FrozenTree {
+ public:
+  explicit FrozenTree(CompareT compare);
+  FrozenTree(const FrozenTree &) = delete;
+  FrozenTree(FrozenTree &&) = delete;
+  FrozenTree &operator=(const FrozenTree &) = delete;
+  FrozenTree &operator=(FrozenTree &&) = delete;
+  void build(const std::vector<T> &sorted);
+  bool contains(T value) const;
+  // первый элемент не меньше value или nullptr, если такого нет
+  const T *lower_bound(T value) const;
+ private:
+  // элемент 0 не используется
+  std::vector<T> layout;
+  CompareT compare;
+};
+
+template<typename T, typename CompareT>
+FrozenTree<T, CompareT>::FrozenTree(CompareT compare) {
+  this->compare = compare;
+}
+
+template<typename T, typename CompareT>
+void FrozenTree<T, CompareT>::build(const std::vector<T> &sorted) {
+  size_t n = sorted.size();
+  layout.assign(n + 1, T());
+  // обходим неявное дерево in-order и раскладываем отсортированные значения по вершинам
+  size_t next = 0;
+  size_t k = 1;
+  std::vector<size_t> stack;
+  while (k <= n or !stack.empty()) {
+    while (k <= n) {
+      stack.push_back(k);
+      k = 2 * k;
+    }
+    k = stack.back();
+    stack.pop_back();
+    layout[k] = sorted[next++];
+    k = 2 * k + 1;
+  }
+}
+
+template<typename T, typename CompareT>
+const T *FrozenTree<T, CompareT>::lower_bound(T value) const {
+  size_t n = layout.size() - 1;
+  size_t k = 1;
+  // спуск без ветвлений: бит пути 1 означает переход вправо
+  while (k <= n) {
+    T current = layout[k];
+    k = 2 * k + static_cast<size_t>(compare(current, value));
+  }
+  // последний переход влево был в искомую вершину: отбрасываем хвост из правых переходов и его
+  while (k & 1) {
+    k >>= 1;
+  }
+  k >>= 1;
+  return k == 0 ? nullptr : &layout[k];
+}
+
+template<typename T, typename CompareT>
+bool FrozenTree<T, CompareT>::contains(T value) const {
+  auto found = lower_bound(value);
+  if (found == nullptr) return false;
+  T current = *found;
+  return !compare(value, current);
+}
+
+// куски меньше этого строим последовательно
+const size_t ParallelCutoff = 1 << 15;
+// сколько раз подряд разбиение может быть сильно неравным, прежде чем кусок будет построен последовательно
+const int MaxDegenerateLevels = 2;
+
+// Поддерево, которое осталось построить: его значения в порядке вставки лежат в source[offset, offset + size),
+// и на тех же местах result окажется его pre-order
+template<typename T>
+struct PreOrderTask {
+  T *source;
+  size_t offset;
+  size_t size;
+  // сколько разбиений подряд над этим поддеревом были сильно неравными
+  int degenerate_levels;
+};
+
+// Форма дерева зависит только от порядка вставки: первый элемент - корень, левое поддерево
+// строится из меньших элементов, правое - из остальных, в том же порядке.
+// Поэтому поддеревья можно строить независимо, pre-order получается как корень + левое + правое,
+// и место каждого поддерева в ответе известно заранее: корень, за ним left_size мест левого поддерева,
+// затем правое. Рекурсии нет: потоки берут поддеревья из общего стека задач, большие разбивают
+// (устойчиво переносят значения в другой буфер на места будущего ответа) и кладут части обратно,
+// а небольшие строят последовательно и пишут прямо в свой кусок result.
+// Разбиение окупается и на одном потоке: дерево из ParallelCutoff вершин помещается в кеш, а целое - нет
+template<typename T, typename CompareT>
+std::vector<T> parallel_pre_order(const std::vector<T> &values, CompareT compare, int threads) {
+  std::vector<T> result;
+  if (values.size() <= ParallelCutoff) {
+    SimpleTree<T, CompareT> tree(compare);
+    tree.reserve(static_cast<int>(values.size()));
+    for (const T &value : values) {
+      tree.add(value);
+    }
+    result.reserve(values.size());
+    tree.pre_order_values(&result);
+    return result;
+  }
+
+  // значения поддеревьев перекладываются между scratch и result, пока не дойдут до последовательного построения
+  std::vector<T> scratch(values);
+  result.resize(values.size());
+  std::vector<PreOrderTask<T>> tasks;
+  tasks.push_back(PreOrderTask<T>{scratch.data(), 0, values.size(), 0});
+  std::mutex mutex;
+  std::condition_variable changed;
+  // задачи, которые сейчас обрабатываются: пока они есть, стек может пополниться
+  int running = 0;
+
+  auto build = [&](const PreOrderTask<T> &task) {
+    SimpleTree<T, CompareT> tree(compare);
+    tree.reserve(static_cast<int>(task.size));
+    for (size_t i = task.offset; i < task.offset + task.size; ++i) {
+      tree.add(task.source[i]);
+    }
+    std::vector<T> pre_order;
+    pre_order.reserve(task.size);
+    tree.pre_order_values(&pre_order);
+    std::copy(pre_order.begin(), pre_order.end(), result.begin() + task.offset);
+  };
+  // возвращает число задач, положенных в children
+  auto split = [&](const PreOrderTask<T> &task, PreOrderTask<T> *children) {
+    T *target = task.source == scratch.data() ? result.data() : scratch.data();
+    T root = task.source[task.offset];
+    size_t end = task.offset + task.size;
+    size_t left_size = 0;
+    for (size_t i = task.offset + 1; i < end; ++i) {
+      T value = task.source[i];
+      left_size += compare(value, root);
+    }
+    size_t right_size = task.size - 1 - left_size;
+    size_t left = task.offset + 1;
+    size_t right = left + left_size;
+    for (size_t i = task.offset + 1; i < end; ++i) {
+      T value = task.source[i];
+      compare(value, root) ? target[left++] = value : target[right++] = value;
+    }
+    result[task.offset] = root;
+    // почти отсортированный вход: после нескольких таких разбиений подряд кусок строится последовательно
+    int degenerate_levels = std::min(left_size, right_size) < task.size / 8 ? task.degenerate_levels + 1 : 0;
+    int count = 0;
+    if (left_size > 0) children[count++] = PreOrderTask<T>{target, task.offset + 1, left_size, degenerate_levels};
+    if (right_size > 0) {
+      children[count++] = PreOrderTask<T>{target, task.offset + 1 + left_size, right_size, degenerate_levels};
+    }
+    return count;
+  };
+  auto worker = [&]() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      changed.wait(lock, [&]() { return !tasks.empty() or running == 0; });
+      if (tasks.empty()) return;
+      PreOrderTask<T> task = tasks.back();
+      tasks.pop_back();
+      ++running;
+      lock.unlock();
+      PreOrderTask<T> children[2];
+      int count = 0;
+      if (task.size <= ParallelCutoff or task.degenerate_levels == MaxDegenerateLevels) {
+        build(task);
+      } else {
+        count = split(task, children);
+      }
+      lock.lock();
+      tasks.insert(tasks.end(), children, children + count);
+      --running;
+      changed.notify_all();
+    }
+  };
+
+  std::vector<std::future<void>> workers;
+  for (int i = 1; i < threads; ++i) {
+    workers.push_back(std::async(std::launch::async, worker));
+  }
+  worker();
+  for (auto &future : workers) {
+    future.get();
+  }
+  return result;
+}
+
+template<typename T>
+class ComparerLess {
+ public:
+  bool operator()(T &first, T &second) const;
+};
+template<typename T>
+bool ComparerLess<T>::operator()(T &first, T &second) const {
+  return first < second;
+}
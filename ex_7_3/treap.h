@@ -0,0 +1,1111 @@
+// Множества с порядковыми статистиками: декартово дерево, B-дерево со счётчиками в узлах
+// и персистентное декартово дерево для читателей из других потоков
+#pragma once
+
+#include <cstdlib>
+#include <vector>
+#include <deque>
+#include <atomic>
+#include <limits>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <memory_resource>
+#include <assert.h>
+#include "../common/fast_io.h"
+
+template<typename T>
+struct TreapNode {
+  explicit TreapNode(T value) {
+    this->value = value;
+    priority = random();
+  }
+  T value;
+  int priority;
+  // количество копий значения, больше 1 только в режиме подсчёта повторов
+  int count = 1;
+  // сумма count по поддереву
+  int subtree_size = 1;
+  TreapNode<T> *left = nullptr;
+  TreapNode<T> *right = nullptr;
+};
+
+// Пакет, который меньше дерева больше чем в столько раз, add_many и remove_many обрабатывают по одному значению:
+// общий проход по дереву окупается только на плотных пакетах, где у путей к соседним значениям много общего
+const size_t SmallBatchRatio = 64;
+
+// при CountDuplicates = true одинаковые значения хранятся в одной вершине со счётчиком
+template<typename T, typename CompareT, bool CountDuplicates = false>
+class Treap {
+ public:
+  // вершины выделяются из resource, например из MonotonicArena или FixedSizePool
+  explicit Treap(CompareT compare, std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+  ~Treap();
+  Treap(const Treap &) = delete;
+  Treap(Treap &&) = delete;
+  Treap &operator=(const Treap &) = delete;
+  Treap &operator=(Treap &&) = delete;
+  void add(T value);
+  void remove(T value);
+  // пакетные операции, values должны быть отсортированы
+  void build_from_sorted(const std::vector<T> &values);
+  void add_many(const std::vector<T> &values);
+  void remove_many(const std::vector<T> &values);
+  T get_k_stat(int k) const;
+  // количество элементов меньше value
+  int rank(T value) const;
+  // количество элементов из отрезка [low, high]
+  int count_in_range(T low, T high) const;
+  // порядковые статистики для отсортированных ks за один общий спуск
+  std::vector<T> get_k_stats(const std::vector<int> &ks) const;
+ private:
+  TreapNode<T> *root = nullptr;
+  CompareT compare;
+  std::pmr::polymorphic_allocator<TreapNode<T>> allocator;
+  TreapNode<T> *new_node(T value);
+  void free_node(TreapNode<T> *node);
+  static TreapNode<T> *merge(TreapNode<T> *left, TreapNode<T> *right);
+  static std::pair<TreapNode<T> *, TreapNode<T> *> split(TreapNode<T> *node, T value, CompareT compare_);
+  TreapNode<T> *build_subtree(const std::vector<T> &values, CompareT compare_);
+  static TreapNode<T> *extract_min_if_equal(TreapNode<T> **slot, T &value, CompareT compare_);
+  TreapNode<T> *unite(TreapNode<T> *first, TreapNode<T> *second, CompareT compare_);
+  TreapNode<T> *erase_batch(TreapNode<T> *node, const T *first, const T *last, CompareT compare_);
+  static void select_batch(TreapNode<T> *node, const int *first, const int *last, int offset, T *result);
+  static bool is_equal(T &first, T &second, CompareT compare_);
+  static int get_subtree_size(TreapNode<T> *node);
+  static void update_subtree_size(TreapNode<T> *node);
+  void delete_subtree(TreapNode<T> *node);
+};
+
+template<typename T, typename CompareT, bool CountDuplicates>
+Treap<T, CompareT, CountDuplicates>::Treap(CompareT compare, std::pmr::memory_resource *resource)
+    : allocator(resource) {
+  this->compare = compare;
+}
+
+template<typename T, typename CompareT, bool CountDuplicates>
+TreapNode<T> *Treap<T, CompareT, CountDuplicates>::new_node(T value) {
+  auto node = allocator.allocate(1);
+  new(node) TreapNode<T>(value);
+  return node;
+}
+
+template<typename T, typename CompareT, bool CountDuplicates>
+void Treap<T, CompareT, CountDuplicates>::free_node(TreapNode<T> *node) {
+  node->~TreapNode<T>();
+  allocator.deallocate(node, 1);
+}
+
+template<typename T, typename CompareT, bool CountDuplicates>
+TreapNode<T> *Treap<T, CompareT, CountDuplicates>::merge(TreapNode<T> *left, TreapNode<T> *right) {
+  TreapNode<T> *new_root = nullptr;
+  // slot указывает на место, куда нужно подвесить следующую вершину
+  TreapNode<T> **slot = &new_root;
+  while (left != nullptr and right != nullptr) {
+    if (left->priority < right->priority) {
+      // вся правая часть окажется в правом поддереве left
+      left->subtree_size += right->subtree_size;
+      *slot = left;
+      slot = &left->right;
+      left = left->right;
+    } else {
+      right->subtree_size += left->subtree_size;
+      *slot = right;
+      slot = &right->left;
+      right = right->left;
+    }
+  }
+  *slot = left == nullptr ? right : left;
+  return new_root;
+}
+
+template<typename T, typename CompareT, bool CountDuplicates>
+std::pair<TreapNode<T> *, TreapNode<T> *> Treap<T, CompareT, CountDuplicates>::split(TreapNode<T> *node, T value, CompareT compare_) {
+  // первым проходом считаем сколько элементов окажется в левой части,
+  // тогда размеры поддеревьев можно выставить сверху вниз без стека
+  int left_size = 0;
+  for (auto current = node; current != nullptr;) {
+    if (compare_(current->value, value)) {
+      left_size += get_subtree_size(current->left) + current->count;
+      current = current->right;
+    } else {
+      current = current->left;
+    }
+  }
+  int right_size = get_subtree_size(node) - left_size;
+
+  TreapNode<T> *left_root = nullptr;
+  TreapNode<T> *right_root = nullptr;
+  TreapNode<T> **left_slot = &left_root;
+  TreapNode<T> **right_slot = &right_root;
+  while (node != nullptr) {
+    if (compare_(node->value, value)) {
+      // вершина уходит в левую часть вместе со своим левым поддеревом
+      node->subtree_size = left_size;
+      left_size -= get_subtree_size(node->left) + node->count;
+      *left_slot = node;
+      left_slot = &node->right;
+      node = node->right;
+    } else {
+      node->subtree_size = right_size;
+      right_size -= get_subtree_size(node->right) + node->count;
+      *right_slot = node;
+      right_slot = &node->left;
+      node = node->left;
+    }
+  }
+  *left_slot = nullptr;
+  *right_slot = nullptr;
+  return std::make_pair(left_root, right_root);
+}
+
+template<typename T, typename CompareT, bool CountDuplicates>
+bool Treap<T, CompareT, CountDuplicates>::is_equal(T &first, T &second, CompareT compare_) {
+  return !compare_(first, second) and !compare_(second, first);
+}
+
+template<typename T, typename CompareT, bool CountDuplicates>
+void Treap<T, CompareT, CountDuplicates>::add(T value) {
+  if (CountDuplicates) {
+    // если значение уже есть, увеличиваем счётчик его вершины и размеры на пути к ней
+    auto current = root;
+    while (current != nullptr and !is_equal(current->value, value, compare)) {
+      current = compare(current->value, value) ? current->right : current->left;
+    }
+    if (current != nullptr) {
+      for (auto node = root; node != current;) {
+        ++node->subtree_size;
+        node = compare(node->value, value) ? node->right : node->left;
+      }
+      ++current->subtree_size;
+      ++current->count;
+      return;
+    }
+  }
+
+  auto node = new_node(value);
+  // спускаемся, пока приоритет новой вершины не позволит ей встать на место текущей,
+  // все вершины на пути получают нового потомка
+  TreapNode<T> **slot = &root;
+  while (*slot != nullptr and (*slot)->priority < node->priority) {
+    ++(*slot)->subtree_size;
+    slot = compare((*slot)->value, value) ? &(*slot)->right : &(*slot)->left;
+  }
+  // разрезаем только поддерево, на место которого встаёт новая вершина
+  auto splited = split(*slot, value, compare);
+  node->left = splited.first;
+  node->right = splited.second;
+  update_subtree_size(node);
+  *slot = node;
+}
+
+template<typename T, typename CompareT, bool CountDuplicates>
+void Treap<T, CompareT, CountDuplicates>::remove(T value) {
+  // сначала убеждаемся что элемент есть, чтобы не испортить размеры поддеревьев
+  auto current = root;
+  while (current != nullptr and !is_equal(current->value, value, compare)) {
+    current = compare(current->value, value) ? current->right : current->left;
+  }
+  if (current == nullptr) return;
+
+  // удаляем одну копию: спускаемся тем же путём, уменьшая размеры,
+  // и заменяем найденную вершину слиянием её потомков
+  TreapNode<T> **slot = &root;
+  while (*slot != current) {
+    --(*slot)->subtree_size;
+    slot = compare((*slot)->value, value) ? &(*slot)->right : &(*slot)->left;
+  }
+  if (current->count > 1) {
+    --current->count;
+    --current->subtree_size;
+    return;
+  }
+  *slot = merge(current->left, current->right);
+  free_node(current);
+}
+
+template<typename T, typename CompareT, bool CountDuplicates>
+TreapNode<T> *Treap<T, CompareT, CountDuplicates>::build_subtree(const std::vector<T> &values, CompareT compare_) {
+  // строим дерево за O(n), храня в стеке правую ветвь
+  std::vector<TreapNode<T> *> right_spine;
+  for (const T &value : values) {
+    if (CountDuplicates and !right_spine.empty()) {
+      // последняя добавленная вершина всегда на вершине стека
+      T last_value = right_spine.back()->value;
+      T next_value = value;
+      if (!compare_(last_value, next_value)) {
+        ++right_spine.back()->count;
+        continue;
+      }
+    }
+    auto node = new_node(value);
+    TreapNode<T> *last_popped = nullptr;
+    while (!right_spine.empty() and node->priority < right_spine.back()->priority) {
+      // снятая со стека вершина больше не изменится, можно посчитать её размер
+      last_popped = right_spine.back();
+      right_spine.pop_back();
+      update_subtree_size(last_popped);
+    }
+    node->left = last_popped;
+    if (!right_spine.empty()) {
+      right_spine.back()->right = node;
+    }
+    right_spine.push_back(node);
+  }
+  if (right_spine.empty()) return nullptr;
+  while (right_spine.size() > 1) {
+    auto node = right_spine.back();
+    right_spine.pop_back();
+    update_subtree_size(node);
+  }
+  auto new_root = right_spine.back();
+  update_subtree_size(new_root);
+  return new_root;
+}
+
+template<typename T, typename CompareT, bool CountDuplicates>
+void Treap<T, CompareT, CountDuplicates>::build_from_sorted(const std::vector<T> &values) {
+  assert(std::is_sorted(values.begin(), values.end(), [this](T first, T second) {
+    return compare(first, second);
+  }));
+  delete_subtree(root);
+  root = build_subtree(values, compare);
+}
+
+template<typename T, typename CompareT, bool CountDuplicates>
+TreapNode<T> *Treap<T, CompareT, CountDuplicates>::extract_min_if_equal(TreapNode<T> **slot, T &value, CompareT compare_) {
+  if (*slot == nullptr) return nullptr;
+  auto minimum = *slot;
+  while (minimum->left != nullptr) {
+    minimum = minimum->left;
+  }
+  if (!is_equal(minimum->value, value, compare_)) return nullptr;
+  while (*slot != minimum) {
+    (*slot)->subtree_size -= minimum->count;
+    slot = &(*slot)->left;
+  }
+  *slot = minimum->right;
+  return minimum;
+}
+
+template<typename T, typename CompareT, bool CountDuplicates>
+TreapNode<T> *Treap<T, CompareT, CountDuplicates>::unite(TreapNode<T> *first, TreapNode<T> *second, CompareT compare_) {
+  if (first == nullptr) return second;
+  if (second == nullptr) return first;
+  if (second->priority < first->priority) std::swap(first, second);
+  // first остаётся корнем, second разрезаем по его ключу и объединяем половины с потомками
+  auto splited = split(second, first->value, compare_);
+  if (CountDuplicates) {
+    // копии ключа first из второго дерева могут быть только в одной вершине - минимальной в правой части
+    auto equal_node = extract_min_if_equal(&splited.second, first->value, compare_);
+    if (equal_node != nullptr) {
+      first->count += equal_node->count;
+      free_node(equal_node);
+    }
+  }
+  first->left = unite(first->left, splited.first, compare_);
+  first->right = unite(first->right, splited.second, compare_);
+  update_subtree_size(first);
+  return first;
+}
+
+template<typename T, typename CompareT, bool CountDuplicates>
+void Treap<T, CompareT, CountDuplicates>::add_many(const std::vector<T> &values) {
+  assert(std::is_sorted(values.begin(), values.end(), [this](T first, T second) {
+    return compare(first, second);
+  }));
+  if (values.size() * SmallBatchRatio < static_cast<size_t>(get_subtree_size(root))) {
+    for (T value : values) add(value);
+    return;
+  }
+  root = unite(root, build_subtree(values, compare), compare);
+}
+
+template<typename T, typename CompareT, bool CountDuplicates>
+TreapNode<T> *Treap<T, CompareT, CountDuplicates>::erase_batch(TreapNode<T> *node, const T *first, const T *last, CompareT compare_) {
+  if (node == nullptr or first == last) return node;
+  // делим пакет на значения меньше, равные и больше ключа вершины
+  auto lower = std::lower_bound(first, last, node->value, [compare_](T value, T key) {
+    return compare_(value, key);
+  });
+  auto upper = std::upper_bound(lower, last, node->value, [compare_](T key, T value) {
+    return compare_(key, value);
+  });
+  node->left = erase_batch(node->left, first, lower, compare_);
+  node->right = erase_batch(node->right, upper, last, compare_);
+  // одна копия удаляется здесь, остальные копии значения удалит remove_many
+  if (lower != upper and node->count > 1) {
+    --node->count;
+  } else if (lower != upper) {
+    auto merged = merge(node->left, node->right);
+    free_node(node);
+    return merged;
+  }
+  update_subtree_size(node);
+  return node;
+}
+
+template<typename T, typename CompareT, bool CountDuplicates>
+void Treap<T, CompareT, CountDuplicates>::remove_many(const std::vector<T> &values) {
+  assert(std::is_sorted(values.begin(), values.end(), [this](T first, T second) {
+    return compare(first, second);
+  }));
+  if (values.empty()) return;
+  if (values.size() * SmallBatchRatio < static_cast<size_t>(get_subtree_size(root))) {
+    for (T value : values) remove(value);
+    return;
+  }
+  // за один проход удаляем по одной копии каждого различного значения
+  root = erase_batch(root, values.data(), values.data() + values.size(), compare);
+  // повторы в пакете удаляем по одному
+  for (size_t i = 1; i < values.size(); ++i) {
+    T previous = values[i - 1];
+    T current = values[i];
+    if (is_equal(previous, current, compare)) {
+      remove(current);
+    }
+  }
+}
+
+template<typename T, typename CompareT, bool CountDuplicates>
+T Treap<T, CompareT, CountDuplicates>::get_k_stat(int k) const {
+  assert(k >= 0 and k < get_subtree_size(root));
+  auto current_element = root;
+  // идём от корня вниз, вершина занимает статистики с left_size по left_size + count - 1
+  while (true) {
+    int left_size = get_subtree_size(current_element->left);
+    if (k < left_size) {
+      current_element = current_element->left;
+    } else if (k >= left_size + current_element->count) {
+      // при переходе вправо статистика отсчитывается от начала правого поддерева
+      k -= left_size + current_element->count;
+      current_element = current_element->right;
+    } else {
+      return current_element->value;
+    }
+  }
+}
+
+template<typename T, typename CompareT, bool CountDuplicates>
+int Treap<T, CompareT, CountDuplicates>::rank(T value) const {
+  int result = 0;
+  auto current = root;
+  while (current != nullptr) {
+    if (compare(current->value, value)) {
+      // текущая вершина и её левое поддерево меньше value
+      result += get_subtree_size(current->left) + current->count;
+      current = current->right;
+    } else {
+      current = current->left;
+    }
+  }
+  return result;
+}
+
+template<typename T, typename CompareT, bool CountDuplicates>
+int Treap<T, CompareT, CountDuplicates>::count_in_range(T low, T high) const {
+  if (compare(high, low)) return 0;
+  // общий участок пути: пока вершина целиком левее или правее отрезка
+  auto current = root;
+  while (current != nullptr) {
+    if (compare(current->value, low)) {
+      current = current->right;
+    } else if (compare(high, current->value)) {
+      current = current->left;
+    } else {
+      break;
+    }
+  }
+  if (current == nullptr) return 0;
+
+  // вершина лежит в отрезке, дальше считаем отдельно элементы >= low слева и <= high справа
+  int result = current->count;
+  for (auto node = current->left; node != nullptr;) {
+    if (compare(node->value, low)) {
+      node = node->right;
+    } else {
+      result += get_subtree_size(node->right) + node->count;
+      node = node->left;
+    }
+  }
+  for (auto node = current->right; node != nullptr;) {
+    if (compare(high, node->value)) {
+      node = node->left;
+    } else {
+      result += get_subtree_size(node->left) + node->count;
+      node = node->right;
+    }
+  }
+  return result;
+}
+
+// offset - количество элементов дерева левее поддерева node
+template<typename T, typename CompareT, bool CountDuplicates>
+void Treap<T, CompareT, CountDuplicates>::select_batch(TreapNode<T> *node, const int *first, const int *last, int offset, T *result) {
+  while (first != last) {
+    int node_stat = offset + get_subtree_size(node->left);
+    if (last - first == 1) {
+      // один запрос на поддерево: обычный спуск, без двоичных поисков по пакету
+      int k = *first;
+      while (k < node_stat or k >= node_stat + node->count) {
+        if (k < node_stat) {
+          node = node->left;
+          node_stat -= get_subtree_size(node->right) + node->count;
+        } else {
+          offset = node_stat + node->count;
+          node = node->right;
+          node_stat = offset + get_subtree_size(node->left);
+        }
+      }
+      *result = node->value;
+      return;
+    }
+    // делим запросы на те, что левее вершины, попадающие в её статистики и правее
+    auto lower = std::lower_bound(first, last, node_stat);
+    auto upper = std::lower_bound(lower, last, node_stat + node->count);
+    if (first != lower) {
+      select_batch(node->left, first, lower, offset, result);
+    }
+    std::fill(result + (lower - first), result + (upper - first), node->value);
+    // правую часть обрабатываем в цикле, чтобы не увеличивать глубину рекурсии
+    result += upper - first;
+    first = upper;
+    offset = node_stat + node->count;
+    node = node->right;
+  }
+}
+
+template<typename T, typename CompareT, bool CountDuplicates>
+std::vector<T> Treap<T, CompareT, CountDuplicates>::get_k_stats(const std::vector<int> &ks) const {
+  assert(std::is_sorted(ks.begin(), ks.end()));
+  assert(ks.empty() or (ks.front() >= 0 and ks.back() < get_subtree_size(root)));
+  std::vector<T> result(ks.size());
+  if (!ks.empty()) {
+    select_batch(root, ks.data(), ks.data() + ks.size(), 0, result.data());
+  }
+  return result;
+}
+
+template<typename T, typename CompareT, bool CountDuplicates>
+void Treap<T, CompareT, CountDuplicates>::delete_subtree(TreapNode<T> *node) {
+  if (!node) return;
+  delete_subtree(node->left);
+  delete_subtree(node->right);
+  free_node(node);
+}
+
+template<typename T, typename CompareT, bool CountDuplicates>
+Treap<T, CompareT, CountDuplicates>::~Treap() {
+  delete_subtree(root);
+}
+
+template<typename T, typename CompareT, bool CountDuplicates>
+int Treap<T, CompareT, CountDuplicates>::get_subtree_size(TreapNode<T> *node) {
+  return node == nullptr ? 0 : node->subtree_size;
+}
+
+template<typename T, typename CompareT, bool CountDuplicates>
+void Treap<T, CompareT, CountDuplicates>::update_subtree_size(TreapNode<T> *node) {
+  node->subtree_size = get_subtree_size(node->left) + get_subtree_size(node->right) + node->count;
+}
+
+// B-дерево с количеством элементов в поддеревьях: широкие узлы дают меньше промахов кэша
+// при поиске порядковой статистики, интерфейс совпадает с Treap
+template<typename T, int Order>
+struct CountedBTreeNode {
+  bool is_leaf = true;
+  // в листе - количество значений, во внутреннем узле - количество детей
+  int size = 0;
+  // в листе - значения, во внутреннем узле keys[i] разделяет детей i и i + 1
+  T keys[Order];
+  int counts[Order];
+  CountedBTreeNode<T, Order> *children[Order];
+};
+
+template<typename T, typename CompareT, int Order = 64>
+class CountedBTree {
+ public:
+  explicit CountedBTree(CompareT compare);
+  ~CountedBTree();
+  CountedBTree(const CountedBTree &) = delete;
+  CountedBTree(CountedBTree &&) = delete;
+  CountedBTree &operator=(const CountedBTree &) = delete;
+  CountedBTree &operator=(CountedBTree &&) = delete;
+  void add(T value);
+  void remove(T value);
+  T get_k_stat(int k) const;
+ private:
+  typedef CountedBTreeNode<T, Order> Node;
+  static const int min_size = Order / 2;
+  Node *root = new Node();
+  int elements_count = 0;
+  CompareT compare;
+  int lower_index(T *keys, int n, T &value) const;
+  int upper_index(T *keys, int n, T &value) const;
+  bool erase(Node *node, T &value);
+  static int get_node_count(Node *node);
+  static void split_child(Node *parent, int i);
+  static void rebalance(Node *parent, int i);
+  static void merge_children(Node *parent, int i);
+  static void delete_subtree(Node *node);
+};
+
+template<typename T, typename CompareT, int Order>
+CountedBTree<T, CompareT, Order>::CountedBTree(CompareT compare) {
+  static_assert(Order >= 4, "B-tree order is too small");
+  this->compare = compare;
+}
+
+template<typename T, typename CompareT, int Order>
+CountedBTree<T, CompareT, Order>::~CountedBTree() {
+  delete_subtree(root);
+}
+
+template<typename T, typename CompareT, int Order>
+void CountedBTree<T, CompareT, Order>::delete_subtree(Node *node) {
+  if (!node->is_leaf) {
+    for (int i = 0; i < node->size; ++i) {
+      delete_subtree(node->children[i]);
+    }
+  }
+  delete node;
+}
+
+// индекс первого ключа не меньше value
+template<typename T, typename CompareT, int Order>
+int CountedBTree<T, CompareT, Order>::lower_index(T *keys, int n, T &value) const {
+  int i = 0;
+  while (i < n and compare(keys[i], value)) ++i;
+  return i;
+}
+
+// индекс первого ключа больше value
+template<typename T, typename CompareT, int Order>
+int CountedBTree<T, CompareT, Order>::upper_index(T *keys, int n, T &value) const {
+  int i = 0;
+  while (i < n and !compare(value, keys[i])) ++i;
+  return i;
+}
+
+template<typename T, typename CompareT, int Order>
+int CountedBTree<T, CompareT, Order>::get_node_count(Node *node) {
+  if (node->is_leaf) return node->size;
+  int count = 0;
+  for (int i = 0; i < node->size; ++i) {
+    count += node->counts[i];
+  }
+  return count;
+}
+
+// делит заполненного ребёнка i пополам, вторая половина становится ребёнком i + 1
+template<typename T, typename CompareT, int Order>
+void CountedBTree<T, CompareT, Order>::split_child(Node *parent, int i) {
+  Node *child = parent->children[i];
+  auto sibling = new Node();
+  sibling->is_leaf = child->is_leaf;
+  T separator;
+  if (child->is_leaf) {
+    sibling->size = Order - min_size;
+    std::copy(child->keys + min_size, child->keys + Order, sibling->keys);
+    separator = sibling->keys[0];
+  } else {
+    sibling->size = Order - min_size;
+    std::copy(child->keys + min_size, child->keys + Order - 1, sibling->keys);
+    std::copy(child->counts + min_size, child->counts + Order, sibling->counts);
+    std::copy(child->children + min_size, child->children + Order, sibling->children);
+    separator = child->keys[min_size - 1];
+  }
+  child->size = min_size;
+
+  std::copy_backward(parent->children + i + 1, parent->children + parent->size, parent->children + parent->size + 1);
+  std::copy_backward(parent->counts + i + 1, parent->counts + parent->size, parent->counts + parent->size + 1);
+  std::copy_backward(parent->keys + i, parent->keys + parent->size - 1, parent->keys + parent->size);
+  int sibling_count = get_node_count(sibling);
+  parent->children[i + 1] = sibling;
+  parent->counts[i + 1] = sibling_count;
+  parent->counts[i] -= sibling_count;
+  parent->keys[i] = separator;
+  ++parent->size;
+}
+
+template<typename T, typename CompareT, int Order>
+void CountedBTree<T, CompareT, Order>::add(T value) {
+  // заполненные узлы делим заранее, на спуске, чтобы не подниматься обратно
+  if (root->size == Order) {
+    auto new_root = new Node();
+    new_root->is_leaf = false;
+    new_root->size = 1;
+    new_root->children[0] = root;
+    new_root->counts[0] = elements_count;
+    root = new_root;
+    split_child(root, 0);
+  }
+  ++elements_count;
+  Node *node = root;
+  while (!node->is_leaf) {
+    int i = upper_index(node->keys, node->size - 1, value);
+    if (node->children[i]->size == Order) {
+      split_child(node, i);
+      if (!compare(value, node->keys[i])) ++i;
+    }
+    ++node->counts[i];
+    node = node->children[i];
+  }
+  int position = upper_index(node->keys, node->size, value);
+  std::copy_backward(node->keys + position, node->keys + node->size, node->keys + node->size + 1);
+  node->keys[position] = value;
+  ++node->size;
+}
+
+// переносит элемент из соседа в ребёнка i, а если у соседей нечего взять - сливает их
+template<typename T, typename CompareT, int Order>
+void CountedBTree<T, CompareT, Order>::rebalance(Node *parent, int i) {
+  Node *child = parent->children[i];
+  if (i > 0 and parent->children[i - 1]->size > min_size) {
+    Node *left = parent->children[i - 1];
+    std::copy_backward(child->keys, child->keys + child->size, child->keys + child->size + 1);
+    if (child->is_leaf) {
+      child->keys[0] = left->keys[left->size - 1];
+      parent->keys[i - 1] = child->keys[0];
+      --parent->counts[i - 1];
+      ++parent->counts[i];
+    } else {
+      int moved_count = left->counts[left->size - 1];
+      std::copy_backward(child->counts, child->counts + child->size, child->counts + child->size + 1);
+      std::copy_backward(child->children, child->children + child->size, child->children + child->size + 1);
+      child->keys[0] = parent->keys[i - 1];
+      child->counts[0] = moved_count;
+      child->children[0] = left->children[left->size - 1];
+      parent->keys[i - 1] = left->keys[left->size - 2];
+      parent->counts[i - 1] -= moved_count;
+      parent->counts[i] += moved_count;
+    }
+    --left->size;
+    ++child->size;
+  } else if (i + 1 < parent->size and parent->children[i + 1]->size > min_size) {
+    Node *right = parent->children[i + 1];
+    if (child->is_leaf) {
+      child->keys[child->size] = right->keys[0];
+      std::copy(right->keys + 1, right->keys + right->size, right->keys);
+      parent->keys[i] = right->keys[0];
+      --parent->counts[i + 1];
+      ++parent->counts[i];
+    } else {
+      int moved_count = right->counts[0];
+      child->keys[child->size - 1] = parent->keys[i];
+      child->counts[child->size] = moved_count;
+      child->children[child->size] = right->children[0];
+      parent->keys[i] = right->keys[0];
+      std::copy(right->keys + 1, right->keys + right->size - 1, right->keys);
+      std::copy(right->counts + 1, right->counts + right->size, right->counts);
+      std::copy(right->children + 1, right->children + right->size, right->children);
+      parent->counts[i + 1] -= moved_count;
+      parent->counts[i] += moved_count;
+    }
+    --right->size;
+    ++child->size;
+  } else if (i > 0) {
+    merge_children(parent, i - 1);
+  } else {
+    merge_children(parent, i);
+  }
+}
+
+// сливает ребёнка i + 1 в ребёнка i
+template<typename T, typename CompareT, int Order>
+void CountedBTree<T, CompareT, Order>::merge_children(Node *parent, int i) {
+  Node *left = parent->children[i];
+  Node *right = parent->children[i + 1];
+  if (left->is_leaf) {
+    std::copy(right->keys, right->keys + right->size, left->keys + left->size);
+  } else {
+    left->keys[left->size - 1] = parent->keys[i];
+    std::copy(right->keys, right->keys + right->size - 1, left->keys + left->size);
+    std::copy(right->counts, right->counts + right->size, left->counts + left->size);
+    std::copy(right->children, right->children + right->size, left->children + left->size);
+  }
+  left->size += right->size;
+  parent->counts[i] += parent->counts[i + 1];
+  std::copy(parent->keys + i + 1, parent->keys + parent->size - 1, parent->keys + i);
+  std::copy(parent->counts + i + 2, parent->counts + parent->size, parent->counts + i + 1);
+  std::copy(parent->children + i + 2, parent->children + parent->size, parent->children + i + 1);
+  --parent->size;
+  delete right;
+}
+
+template<typename T, typename CompareT, int Order>
+bool CountedBTree<T, CompareT, Order>::erase(Node *node, T &value) {
+  if (node->is_leaf) {
+    int position = lower_index(node->keys, node->size, value);
+    if (position == node->size or compare(value, node->keys[position])) return false;
+    std::copy(node->keys + position + 1, node->keys + node->size, node->keys + position);
+    --node->size;
+    return true;
+  }
+  // при повторяющихся значениях подходящих детей может быть несколько
+  int first = lower_index(node->keys, node->size - 1, value);
+  int last = upper_index(node->keys, node->size - 1, value);
+  for (int i = first; i <= last; ++i) {
+    if (erase(node->children[i], value)) {
+      --node->counts[i];
+      if (node->children[i]->size < min_size) rebalance(node, i);
+      return true;
+    }
+  }
+  return false;
+}
+
+template<typename T, typename CompareT, int Order>
+void CountedBTree<T, CompareT, Order>::remove(T value) {
+  if (!erase(root, value)) return;
+  --elements_count;
+  // если у корня остался один ребёнок, дерево становится ниже
+  if (!root->is_leaf and root->size == 1) {
+    Node *old_root = root;
+    root = root->children[0];
+    delete old_root;
+  }
+}
+
+template<typename T, typename CompareT, int Order>
+T CountedBTree<T, CompareT, Order>::get_k_stat(int k) const {
+  assert(k >= 0 and k < elements_count);
+  Node *node = root;
+  while (!node->is_leaf) {
+    int i = 0;
+    while (k >= node->counts[i]) {
+      k -= node->counts[i];
+      ++i;
+    }
+    node = node->children[i];
+  }
+  return node->keys[k];
+}
+
+// Персистентное декартово дерево: один писатель, много читателей без блокировок.
+// Обновление копирует вершины на пути и публикует новый корень атомарно,
+// читатели работают со снимком, который не меняется. Замещённые вершины
+// освобождаются, когда из их эпохи не осталось активных читателей.
+template<typename T>
+struct PersistentTreapNode {
+  T value;
+  int priority;
+  int subtree_size;
+  PersistentTreapNode<T> *left;
+  PersistentTreapNode<T> *right;
+};
+
+template<typename T, typename CompareT>
+class PersistentTreap {
+ private:
+  struct ReaderSlot;
+
+ public:
+  typedef PersistentTreapNode<T> Node;
+
+  // Снимок держит эпоху своего читателя, пока жив; уничтожать его нужно в потоке этого читателя
+  class Snapshot {
+   public:
+    Snapshot(ReaderSlot *reader, const Node *root);
+    Snapshot(Snapshot &&other) noexcept;
+    ~Snapshot();
+    Snapshot(const Snapshot &) = delete;
+    Snapshot &operator=(const Snapshot &) = delete;
+    Snapshot &operator=(Snapshot &&) = delete;
+    int size() const;
+    T get_k_stat(int k) const;
+   private:
+    ReaderSlot *reader;
+    const Node *root;
+  };
+
+  PersistentTreap(CompareT compare, int max_readers);
+  ~PersistentTreap();
+  PersistentTreap(const PersistentTreap &) = delete;
+  PersistentTreap(PersistentTreap &&) = delete;
+  PersistentTreap &operator=(const PersistentTreap &) = delete;
+  PersistentTreap &operator=(PersistentTreap &&) = delete;
+  // методы писателя, вызываются из одного потока
+  void add(T value);
+  void remove(T value);
+  // методы читателей, каждый поток регистрируется один раз.
+  // У читателя может быть сразу несколько живых снимков: эпоха объявляется первым из них
+  // и снимается, когда уничтожен последний
+  int register_reader();
+  Snapshot snapshot(int reader) const;
+ private:
+  static const uint64_t inactive_epoch = std::numeric_limits<uint64_t>::max();
+  // эпоха читателя в отдельной кэш-линии, чтобы читатели не мешали друг другу
+  struct alignas(64) ReaderSlot {
+    std::atomic<uint64_t> epoch{inactive_epoch};
+    // живые снимки читателя, меняется только его потоком
+    int snapshots = 0;
+  };
+  struct RetiredNodes {
+    uint64_t epoch;
+    std::vector<Node *> nodes;
+  };
+  std::atomic<Node *> root{nullptr};
+  std::atomic<uint64_t> global_epoch{0};
+  std::atomic<int> readers_count{0};
+  int max_readers;
+  ReaderSlot *readers;
+  // вершины, замещённые текущим обновлением и предыдущими, ещё не освобождёнными
+  std::vector<Node *> retiring;
+  std::deque<RetiredNodes> retired;
+  CompareT compare;
+  Node *clone(const Node *node);
+  std::pair<Node *, Node *> split(Node *node, T &value);
+  Node *merge(Node *left, Node *right);
+  void publish(Node *new_root);
+  void reclaim();
+  static int get_subtree_size(const Node *node);
+  static void delete_subtree(Node *node);
+};
+
+template<typename T, typename CompareT>
+PersistentTreap<T, CompareT>::Snapshot::Snapshot(ReaderSlot *reader, const Node *root) {
+  this->reader = reader;
+  this->root = root;
+}
+
+template<typename T, typename CompareT>
+PersistentTreap<T, CompareT>::Snapshot::Snapshot(Snapshot &&other) noexcept {
+  reader = other.reader;
+  root = other.root;
+  other.reader = nullptr;
+}
+
+template<typename T, typename CompareT>
+PersistentTreap<T, CompareT>::Snapshot::~Snapshot() {
+  if (reader != nullptr and --reader->snapshots == 0) reader->epoch.store(inactive_epoch);
+}
+
+template<typename T, typename CompareT>
+int PersistentTreap<T, CompareT>::Snapshot::size() const {
+  return get_subtree_size(root);
+}
+
+template<typename T, typename CompareT>
+T PersistentTreap<T, CompareT>::Snapshot::get_k_stat(int k) const {
+  assert(k >= 0 and k < size());
+  auto current = root;
+  while (true) {
+    int left_size = get_subtree_size(current->left);
+    if (k < left_size) {
+      current = current->left;
+    } else if (k > left_size) {
+      k -= left_size + 1;
+      current = current->right;
+    } else {
+      return current->value;
+    }
+  }
+}
+
+template<typename T, typename CompareT>
+PersistentTreap<T, CompareT>::PersistentTreap(CompareT compare, int max_readers) {
+  this->compare = compare;
+  this->max_readers = max_readers;
+  readers = new ReaderSlot[max_readers];
+}
+
+template<typename T, typename CompareT>
+PersistentTreap<T, CompareT>::~PersistentTreap() {
+  delete_subtree(root.load());
+  for (auto node : retiring) delete node;
+  for (auto &batch : retired) {
+    for (auto node : batch.nodes) delete node;
+  }
+  delete[] readers;
+}
+
+template<typename T, typename CompareT>
+int PersistentTreap<T, CompareT>::register_reader() {
+  int reader = readers_count.fetch_add(1);
+  assert(reader < max_readers);
+  return reader;
+}
+
+template<typename T, typename CompareT>
+typename PersistentTreap<T, CompareT>::Snapshot PersistentTreap<T, CompareT>::snapshot(int reader) const {
+  // сначала объявляем эпоху, и только потом читаем корень:
+  // писатель не освободит вершины, которые могли быть видны в этой эпохе.
+  // Если у читателя уже есть снимок, его более ранняя эпоха защищает и новый корень:
+  // всё, что видно из корня сейчас, замещается не раньше текущей эпохи
+  auto slot = &readers[reader];
+  if (slot->snapshots++ == 0) slot->epoch.store(global_epoch.load());
+  return Snapshot(slot, root.load());
+}
+
+template<typename T, typename CompareT>
+int PersistentTreap<T, CompareT>::get_subtree_size(const Node *node) {
+  return node == nullptr ? 0 : node->subtree_size;
+}
+
+template<typename T, typename CompareT>
+void PersistentTreap<T, CompareT>::delete_subtree(Node *node) {
+  if (!node) return;
+  delete_subtree(node->left);
+  delete_subtree(node->right);
+  delete node;
+}
+
+// опубликованные вершины не меняются, вместо этого меняем копию, а оригинал откладываем на удаление
+template<typename T, typename CompareT>
+PersistentTreapNode<T> *PersistentTreap<T, CompareT>::clone(const Node *node) {
+  retiring.push_back(const_cast<Node *>(node));
+  return new Node(*node);
+}
+
+template<typename T, typename CompareT>
+std::pair<PersistentTreapNode<T> *, PersistentTreapNode<T> *> PersistentTreap<T, CompareT>::split(Node *node,
+                                                                                                T &value) {
+  // так же как в Treap::split, но вершины на пути разреза копируются
+  int left_size = 0;
+  for (auto current = node; current != nullptr;) {
+    if (compare(current->value, value)) {
+      left_size += get_subtree_size(current->left) + 1;
+      current = current->right;
+    } else {
+      current = current->left;
+    }
+  }
+  int right_size = get_subtree_size(node) - left_size;
+
+  Node *left_root = nullptr;
+  Node *right_root = nullptr;
+  Node **left_slot = &left_root;
+  Node **right_slot = &right_root;
+  while (node != nullptr) {
+    auto copy = clone(node);
+    if (compare(node->value, value)) {
+      copy->subtree_size = left_size;
+      left_size -= get_subtree_size(node->left) + 1;
+      *left_slot = copy;
+      left_slot = &copy->right;
+      node = node->right;
+    } else {
+      copy->subtree_size = right_size;
+      right_size -= get_subtree_size(node->right) + 1;
+      *right_slot = copy;
+      right_slot = &copy->left;
+      node = node->left;
+    }
+  }
+  *left_slot = nullptr;
+  *right_slot = nullptr;
+  return std::make_pair(left_root, right_root);
+}
+
+template<typename T, typename CompareT>
+PersistentTreapNode<T> *PersistentTreap<T, CompareT>::merge(Node *left, Node *right) {
+  Node *new_root = nullptr;
+  Node **slot = &new_root;
+  while (left != nullptr and right != nullptr) {
+    if (left->priority < right->priority) {
+      auto copy = clone(left);
+      copy->subtree_size += right->subtree_size;
+      *slot = copy;
+      slot = &copy->right;
+      left = left->right;
+    } else {
+      auto copy = clone(right);
+      copy->subtree_size += left->subtree_size;
+      *slot = copy;
+      slot = &copy->left;
+      right = right->left;
+    }
+  }
+  *slot = left == nullptr ? right : left;
+  return new_root;
+}
+
+template<typename T, typename CompareT>
+void PersistentTreap<T, CompareT>::add(T value) {
+  auto new_node = new Node{value, static_cast<int>(random()), 1, nullptr, nullptr};
+  Node *new_root = nullptr;
+  Node **slot = &new_root;
+  Node *current = root.load();
+  while (current != nullptr and current->priority < new_node->priority) {
+    auto copy = clone(current);
+    ++copy->subtree_size;
+    *slot = copy;
+    if (compare(current->value, value)) {
+      slot = &copy->right;
+      current = current->right;
+    } else {
+      slot = &copy->left;
+      current = current->left;
+    }
+  }
+  auto splited = split(current, value);
+  new_node->left = splited.first;
+  new_node->right = splited.second;
+  new_node->subtree_size = get_subtree_size(splited.first) + get_subtree_size(splited.second) + 1;
+  *slot = new_node;
+  publish(new_root);
+}
+
+template<typename T, typename CompareT>
+void PersistentTreap<T, CompareT>::remove(T value) {
+  Node *current = root.load();
+  while (current != nullptr and (compare(current->value, value) or compare(value, current->value))) {
+    current = compare(current->value, value) ? current->right : current->left;
+  }
+  if (current == nullptr) return;
+
+  Node *new_root = nullptr;
+  Node **slot = &new_root;
+  for (Node *node = root.load(); node != current;) {
+    auto copy = clone(node);
+    --copy->subtree_size;
+    *slot = copy;
+    if (compare(node->value, value)) {
+      slot = &copy->right;
+      node = node->right;
+    } else {
+      slot = &copy->left;
+      node = node->left;
+    }
+  }
+  *slot = merge(current->left, current->right);
+  retiring.push_back(current);
+  publish(new_root);
+}
+
+template<typename T, typename CompareT>
+void PersistentTreap<T, CompareT>::publish(Node *new_root) {
+  root.store(new_root);
+  // читатели, вошедшие после смены эпохи, уже видят новый корень
+  uint64_t epoch = global_epoch.fetch_add(1);
+  if (!retiring.empty()) {
+    retired.push_back(RetiredNodes{epoch, std::move(retiring)});
+    retiring.clear();
+  }
+  reclaim();
+}
+
+template<typename T, typename CompareT>
+void PersistentTreap<T, CompareT>::reclaim() {
+  uint64_t min_epoch = inactive_epoch;
+  int readers_registered = std::min(readers_count.load(), max_readers);
+  for (int i = 0; i < readers_registered; ++i) {
+    min_epoch = std::min(min_epoch, readers[i].epoch.load());
+  }
+  // пачку из эпохи e можно освободить, если все активные читатели вошли позже неё
+  while (!retired.empty() and retired.front().epoch < min_epoch) {
+    for (auto node : retired.front().nodes) delete node;
+    retired.pop_front();
+  }
+}
+
+template<typename T>
+class ComparerLess {
+ public:
+  bool operator()(T &first, T &second) const;
+};
+template<typename T>
+bool ComparerLess<T>::operator()(T &first, T &second) const {
+  return first < second;
+}
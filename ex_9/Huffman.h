@@ -0,0 +1,20 @@
+// Интерфейс задачи: потоки байтов и функции архивации, которые нужно реализовать
+#pragma once
+
+typedef unsigned char byte;
+
+struct IInputStream {
+  // возвращает false, если поток закончился
+  virtual bool Read(byte &value) = 0;
+  virtual ~IInputStream() = default;
+};
+
+struct IOutputStream {
+  virtual void Write(byte value) = 0;
+  virtual ~IOutputStream() = default;
+};
+
+// метод архивирует данные из потока original
+void Encode(IInputStream &original, IOutputStream &compressed);
+// метод восстанавливает оригинальные данные
+void Decode(IInputStream &compressed, IOutputStream &original);
@@ -9,6 +9,9 @@
 #include <cassert>
 #include <cstring>
 #include "Huffman.h"
+#include "haffman_tree.h"
+#include "../common/memory_resources.h"
+#include "../common/profiling.h"
 
 typedef unsigned char byte;
 
@@ -59,42 +62,16 @@ unsigned int BitsWriter::buffer_size() {
   return buffer_.size();
 }
 
-struct Node {
-  explicit Node(byte value, int priority, bool empty) {
-    this->value = value;
-    this->priority = priority;
-    this->empty = empty;
-  }
-  byte value;
-  int priority;
-  bool empty;
-  Node *left = nullptr;
-  Node *right = nullptr;
-};
-
-class HaffmanTree {
- public:
-  explicit HaffmanTree(std::map<byte, int> *frequency_map);
-  ~HaffmanTree();
-  HaffmanTree(const HaffmanTree &) = delete;
-  HaffmanTree(HaffmanTree &&) = delete;
-  HaffmanTree &operator=(const HaffmanTree &) = delete;
-  HaffmanTree &operator=(HaffmanTree &&) = delete;
-  void pre_order(std::function<void(Node *)> action);
-  void fill_codes_map(std::map<byte, std::vector<bool>> *map);
-  Node *root = nullptr;
- private:
-  static void generate_codes(Node *node, std::vector<bool> code, std::map<byte, std::vector<bool>> *m);
-};
-
-HaffmanTree::HaffmanTree(std::map<byte, int> *frequency_map) {
-  std::function<bool(Node *, Node *)>
-      comparer = [](Node *first, Node *second) { return second->priority < first->priority; };
-  std::priority_queue<Node *, std::vector<Node *>, std::function<bool(Node *, Node *)>> pq(comparer);
+HaffmanTree::HaffmanTree(std::map<byte, int> *frequency_map, std::pmr::memory_resource *resource)
+    : allocator(resource) {
+  std::function<bool(HaffmanNode *, HaffmanNode *)>
+      comparer = [](HaffmanNode *first, HaffmanNode *second) { return second->priority < first->priority; };
+  std::priority_queue<HaffmanNode *, std::vector<HaffmanNode *>,
+                      std::function<bool(HaffmanNode *, HaffmanNode *)>> pq(comparer);
   std::map<byte, int>::iterator it;
 
   for (it = frequency_map->begin(); it != frequency_map->end(); it++) {
-    pq.push(new Node(it->first, it->second, false));
+    pq.push(new_node(it->first, it->second, false));
   }
 
   while (pq.size() != 1) {
@@ -102,7 +79,7 @@ HaffmanTree::HaffmanTree(std::map<byte, int> *frequency_map) {
     pq.pop();
     auto second = pq.top();
     pq.pop();
-    auto new_element = new Node('\0', first->priority + second->priority, true);
+    auto new_element = new_node('\0', first->priority + second->priority, true);
     new_element->left = first;
     new_element->right = second;
     pq.push(new_element);
@@ -111,7 +88,13 @@ HaffmanTree::HaffmanTree(std::map<byte, int> *frequency_map) {
   root = pq.top();
 }
 
-void HaffmanTree::generate_codes(Node *node, std::vector<bool> code, std::map<byte, std::vector<bool>> *m) {
+HaffmanNode *HaffmanTree::new_node(byte value, int priority, bool empty) {
+  auto node = allocator.allocate(1);
+  new(node) HaffmanNode(value, priority, empty);
+  return node;
+}
+
+void HaffmanTree::generate_codes(HaffmanNode *node, std::vector<bool> code, std::map<byte, std::vector<bool>> *m) {
   if (!node->empty) {
     m->insert(std::pair<byte, std::vector<bool>>(node->value, code));
   }
@@ -135,8 +118,8 @@ void HaffmanTree::fill_codes_map(std::map<byte, std::vector<bool>> *map) {
   generate_codes(root, init_vector, map);
 }
 
-void HaffmanTree::pre_order(std::function<void(Node *)> action) {
-  auto dq = std::deque<Node *>();
+void HaffmanTree::pre_order(std::function<void(HaffmanNode *)> action) {
+  auto dq = std::deque<HaffmanNode *>();
   dq.push_front(root);
   // идём от корня вниз
   while (!dq.empty()) {
@@ -157,8 +140,9 @@ void HaffmanTree::pre_order(std::function<void(Node *)> action) {
 }
 
 HaffmanTree::~HaffmanTree() {
-  pre_order([](Node *node) {
-    delete node;
+  pre_order([this](HaffmanNode *node) {
+    node->~HaffmanNode();
+    allocator.deallocate(node, 1);
   });
 }
 
@@ -223,11 +207,16 @@ static std::vector<byte> encode_stream(IInputStream &input) {
     raw_data.push_back(value);
   }
 
-  auto haffman_tree = new HaffmanTree(&frequency_map);
+  // дерево целиком помещается в буфер на стеке, вершины не выделяются в куче по одной
+  alignas(HaffmanNode) char tree_buffer[MaxHaffmanTreeSize * sizeof(HaffmanNode)];
+  MonotonicArena tree_arena(tree_buffer, sizeof(tree_buffer));
   auto codes_map = std::map<byte, std::vector<bool>>();
-  // для того чтобы каждый раз не генерировать код элемента,
-  // создадим словарь кодов для всех символов алфавита
-  haffman_tree->fill_codes_map(&codes_map);
+  {
+    HaffmanTree haffman_tree(&frequency_map, &tree_arena);
+    // для того чтобы каждый раз не генерировать код элемента,
+    // создадим словарь кодов для всех символов алфавита
+    haffman_tree.fill_codes_map(&codes_map);
+  }
 
   BitsWriter writer;
 
@@ -241,7 +230,6 @@ static std::vector<byte> encode_stream(IInputStream &input) {
       writer.write_bit(bit);
     }
   }
-  delete haffman_tree;
 
   // если размер сжатых данных больше чем не сжатых, то записываем в файл сырые данные
   if (writer.buffer_size() > raw_data.size()) {
@@ -297,12 +285,16 @@ void Decode(IInputStream &compressed, IOutputStream &original) {
     }
     deserialize_frequency_table(&freq_encoded, &frequency_table);
 
-    auto h_tree = new HaffmanTree(&frequency_table);
+    alignas(HaffmanNode) char tree_buffer[MaxHaffmanTreeSize * sizeof(HaffmanNode)];
+    MonotonicArena tree_arena(tree_buffer, sizeof(tree_buffer));
+    HaffmanTree h_tree(&frequency_table, &tree_arena);
 
     // декодируем сообщение
     int last_n_bits = static_cast<int>(raw_data[raw_data.size() - 1]);
     raw_data.pop_back();
-    Node *current_node = h_tree->root;
+    HaffmanNode *current_node = h_tree.root;
+    // участок длится до конца ветки, то есть ровно побитовый цикл
+    PROFILE_REGION("huffman.decode_bits");
     for (int i = 4 + freq_table_size; i < raw_data.size(); ++i) {
       int max_bit;
       // определяем сколько бит из байта надо считать
@@ -321,7 +313,7 @@ void Decode(IInputStream &compressed, IOutputStream &original) {
         // как только опредлелили символ снова делаем текущей нодой корень
         if (!current_node->empty) {
           original.Write(current_node->value);
-          current_node = h_tree->root;
+          current_node = h_tree.root;
         }
 
       }
@@ -332,34 +324,3 @@ void Decode(IInputStream &compressed, IOutputStream &original) {
     }
   }
 }
-
-int main() {
-  // Получаем данные, которые нужно закодировать
-  vector<vector<byte> > input;
-
-  fillInputs(input);
-
-  // Сжимаем данные
-  vector<vector<byte> > compressed;
-  compressed.resize(input.size());
-  for (unsigned int i = 0; i < input.size(); i++) {
-    CInputStream iStream(input[i]);
-    COutputStream oStream(compressed[i]);
-    Encode(iStream, oStream);
-  }
-
-  // Распаковываем сжатые данные и проверяем, что они совпадают с оригиналом
-  for (unsigned int i = 0; i < input.size(); i++) {
-    vector<byte> output;
-    CInputStream iStream(compressed[i]);
-    COutputStream oStream(output);
-    Decode(iStream, oStream);
-    if (!isEqual(input[i], output)) {
-      cout << -1;
-      return 0;
-    }
-  }
-
-  // Вычисляем степень сжатия
-  cout << (100. * calculateSize(compressed) / calculateSize(input));
-}
\ No newline at end of file
@@ -0,0 +1,44 @@
+// Дерево кодов Хаффмана, по которому строятся коды при сжатии и идёт побитовый спуск при распаковке
+#pragma once
+
+#include <vector>
+#include <map>
+#include <deque>
+#include <functional>
+#include <memory_resource>
+#include "Huffman.h"
+
+struct HaffmanNode {
+  explicit HaffmanNode(byte value, int priority, bool empty) {
+    this->value = value;
+    this->priority = priority;
+    this->empty = empty;
+  }
+  byte value;
+  int priority;
+  bool empty;
+  HaffmanNode *left = nullptr;
+  HaffmanNode *right = nullptr;
+};
+
+// в дереве для алфавита из 256 символов не больше 511 вершин
+const int MaxHaffmanTreeSize = 511;
+
+class HaffmanTree {
+ public:
+  // вершины выделяются из resource, например из MonotonicArena на стеке
+  explicit HaffmanTree(std::map<byte, int> *frequency_map,
+                       std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+  ~HaffmanTree();
+  HaffmanTree(const HaffmanTree &) = delete;
+  HaffmanTree(HaffmanTree &&) = delete;
+  HaffmanTree &operator=(const HaffmanTree &) = delete;
+  HaffmanTree &operator=(HaffmanTree &&) = delete;
+  void pre_order(std::function<void(HaffmanNode *)> action);
+  void fill_codes_map(std::map<byte, std::vector<bool>> *map);
+  HaffmanNode *root = nullptr;
+ private:
+  std::pmr::polymorphic_allocator<HaffmanNode> allocator;
+  HaffmanNode *new_node(byte value, int priority, bool empty);
+  static void generate_codes(HaffmanNode *node, std::vector<bool> code, std::map<byte, std::vector<bool>> *m);
+};
@@ -0,0 +1,59 @@
+/*
+ Локальная проверка архиватора: данные из stdin сжимаются и распаковываются обратно,
+ при совпадении с исходными печатается степень сжатия в процентах, иначе -1.
+*/
+#include <vector>
+#include <iostream>
+#include <iterator>
+#include "Huffman.h"
+
+class CInputStream : public IInputStream {
+ public:
+  explicit CInputStream(const std::vector<byte> &data) : data(data) {}
+  bool Read(byte &value) override {
+    if (position == data.size()) return false;
+    value = data[position++];
+    return true;
+  }
+ private:
+  const std::vector<byte> &data;
+  size_t position = 0;
+};
+
+class COutputStream : public IOutputStream {
+ public:
+  explicit COutputStream(std::vector<byte> &data) : data(data) {}
+  void Write(byte value) override {
+    data.push_back(value);
+  }
+ private:
+  std::vector<byte> &data;
+};
+
+int main() {
+  // Получаем данные, которые нужно закодировать
+  std::vector<byte> input((std::istreambuf_iterator<char>(std::cin)), std::istreambuf_iterator<char>());
+
+  // Сжимаем данные
+  std::vector<byte> compressed;
+  {
+    CInputStream iStream(input);
+    COutputStream oStream(compressed);
+    Encode(iStream, oStream);
+  }
+
+  // Распаковываем сжатые данные и проверяем, что они совпадают с оригиналом
+  std::vector<byte> output;
+  {
+    CInputStream iStream(compressed);
+    COutputStream oStream(output);
+    Decode(iStream, oStream);
+  }
+  if (input != output) {
+    std::cout << -1;
+    return 0;
+  }
+
+  // Вычисляем степень сжатия
+  std::cout << (100. * compressed.size() / input.size());
+}